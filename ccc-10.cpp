@@ -24,21 +24,251 @@
     }
 */
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 #include <exception>
+#include <stdexcept>
+#include <array>
+#include <vector>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+
+/*
+    Factorials three ways:
+        - factorial_table: 20! is the largest factorial that fits in uint64_t, so all 21 of them are computed at
+          compile time and a lookup is O(1) - no recursion, no loop.
+        - factorial_as<T>(n): reads the table and, like CheckedInteger in ccc-7.cpp, throws std::overflow_error
+          when n! doesn't fit in T instead of silently wrapping.
+        - big_factorial(n): arbitrary precision past 20!. Multiplying 1 * 2 * 3 * ... one by one keeps multiplying a
+          huge number by a small one; a product tree (binary splitting) multiplies lo..mid and mid+1..hi
+          recursively, so the big multiplications happen between numbers of similar size, where Karatsuba helps.
+*/
+constexpr auto factorial_table = [] {
+    std::array<uint64_t, 21> table{ 1 };
+    for (size_t n { 1 }; n < table.size(); n++) {
+        table[n] = table[n - 1] * n;
+    }
+    return table;
+}();
+static_assert(factorial_table[20] == 2432902008176640000ULL);
+
+template <std::integral T = uint64_t>
+constexpr T factorial_as(int number) {
+    if (number < 0) throw std::range_error{ "Given number too low!" };
+    if (static_cast<size_t>(number) >= factorial_table.size() ||
+        factorial_table[static_cast<size_t>(number)] > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+        throw std::overflow_error{ "OVERFLOW!!!" };
+    }
+    return static_cast<T>(factorial_table[static_cast<size_t>(number)]);
+}
 
 // Yes, using an unsigned int here may be more preferred, but I want to show error testing.
+// Past 12! the result no longer fits in an int: that is now an overflow_error instead of a wrong answer.
 int Factorial(int number) {
-    if (number < 0) throw std::range_error{"Given number too low!"};
-    return number <= 1 ? 1 : Factorial(number-1)*number;
+    return factorial_as<int>(number);
+}
+
+// Unsigned integer of any size: little-endian 32-bit limbs, no leading zero limbs (zero has none at all)
+class BigUnsigned {
+public:
+    BigUnsigned(uint64_t value = 0) {
+        for (; value; value >>= 32) limbs.push_back(static_cast<uint32_t>(value));
+    }
+
+    friend BigUnsigned operator*(const BigUnsigned& a, const BigUnsigned& b) {
+        BigUnsigned result;
+        if (!a.limbs.empty() && !b.limbs.empty()) {
+            result.limbs = multiply(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size());
+            trim(result.limbs);
+        }
+        return result;
+    }
+
+    bool operator==(const BigUnsigned&) const = default;
+    friend bool operator==(const BigUnsigned& a, uint64_t b) { return a == BigUnsigned{ b }; }
+
+    size_t bits() const {
+        if (limbs.empty()) return 0;
+        return 32 * limbs.size() - static_cast<size_t>(__builtin_clz(limbs.back()));
+    }
+
+    // Decimal: peel off 9 digits at a time by dividing by 10^9
+    std::string to_string() const {
+        if (limbs.empty()) return "0";
+        auto remaining = limbs;
+        std::vector<uint32_t> chunks;
+        while (!remaining.empty()) {
+            uint64_t remainder{};
+            for (auto limb = remaining.rbegin(); limb != remaining.rend(); ++limb) {
+                const auto current = (remainder << 32) | *limb;
+                *limb = static_cast<uint32_t>(current / 1'000'000'000);
+                remainder = current % 1'000'000'000;
+            }
+            chunks.push_back(static_cast<uint32_t>(remainder));
+            trim(remaining);
+        }
+        auto text = std::to_string(chunks.back());
+        for (auto chunk = chunks.rbegin() + 1; chunk != chunks.rend(); ++chunk) {
+            const auto digits = std::to_string(*chunk);
+            text.append(9 - digits.size(), '0').append(digits);
+        }
+        return text;
+    }
+
+private:
+    using Limbs = std::vector<uint32_t>;
+    static constexpr size_t karatsuba_threshold { 32 };
+
+    static void trim(Limbs& value) {
+        while (!value.empty() && value.back() == 0) value.pop_back();
+    }
+
+    // result[shift...] += value
+    static void add_shifted(Limbs& result, const Limbs& value, size_t shift) {
+        uint64_t carry{};
+        size_t i{};
+        for (; i < value.size() || carry; i++) {
+            const auto sum = result[shift + i] + carry + (i < value.size() ? value[i] : 0);
+            result[shift + i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+    }
+
+    // value -= other, where other <= value
+    static void subtract(Limbs& value, const Limbs& other) {
+        int64_t borrow{};
+        for (size_t i{}; i < value.size(); i++) {
+            auto difference = static_cast<int64_t>(value[i]) - borrow - (i < other.size() ? other[i] : 0);
+            borrow = difference < 0;
+            value[i] = static_cast<uint32_t>(difference + (borrow << 32));
+        }
+    }
+
+    static Limbs add(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        Limbs sum(std::max(na, nb) + 1);
+        uint64_t carry{};
+        for (size_t i{}; i < sum.size(); i++) {
+            carry += (i < na ? a[i] : 0) + static_cast<uint64_t>(i < nb ? b[i] : 0);
+            sum[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        trim(sum);
+        return sum;
+    }
+
+    static Limbs multiply(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        Limbs result(na + nb + 1);
+        if (na == 0 || nb == 0) return result;
+        if (std::min(na, nb) < karatsuba_threshold) {
+            for (size_t i{}; i < na; i++) {
+                uint64_t carry{};
+                for (size_t j{}; j < nb; j++) {
+                    const auto product = static_cast<uint64_t>(a[i]) * b[j] + result[i + j] + carry;
+                    result[i + j] = static_cast<uint32_t>(product);
+                    carry = product >> 32;
+                }
+                result[i + nb] = static_cast<uint32_t>(carry);
+            }
+            return result;
+        }
+        // Karatsuba: (a1 x + a0)(b1 x + b0) = z2 x^2 + ((a0 + a1)(b0 + b1) - z2 - z0) x + z0 with x = 2^(32 half)
+        const auto half = std::max(na, nb) / 2;
+        if (na <= half || nb <= half) {
+            // lopsided: split only the long operand
+            const bool a_long = na > nb;
+            const auto long_limbs = a_long ? a : b, short_limbs = a_long ? b : a;
+            const auto n_long = a_long ? na : nb, n_short = a_long ? nb : na;
+            add_shifted(result, multiply(long_limbs, half, short_limbs, n_short), 0);
+            add_shifted(result, multiply(long_limbs + half, n_long - half, short_limbs, n_short), half);
+            return result;
+        }
+        auto z0 = multiply(a, half, b, half);
+        auto z2 = multiply(a + half, na - half, b + half, nb - half);
+        const auto a_sum = add(a, half, a + half, na - half);
+        const auto b_sum = add(b, half, b + half, nb - half);
+        auto z1 = multiply(a_sum.data(), a_sum.size(), b_sum.data(), b_sum.size());
+        trim(z0);
+        trim(z2);
+        subtract(z1, z0);
+        subtract(z1, z2);
+        trim(z1);
+        add_shifted(result, z0, 0);
+        add_shifted(result, z1, half);
+        add_shifted(result, z2, 2 * half);
+        return result;
+    }
+
+    Limbs limbs;
+};
+
+// lo * (lo + 1) * ... * hi, as a balanced product tree; short runs are multiplied in uint64_t first
+BigUnsigned range_product(uint64_t lo, uint64_t hi) {
+    if (hi - lo < 16) {
+        BigUnsigned product{ 1 };
+        uint64_t run { 1 };
+        for (auto k = lo; k <= hi; k++) {
+            if (run > std::numeric_limits<uint64_t>::max() / k) {
+                product = product * run;
+                run = 1;
+            }
+            run *= k;
+        }
+        return product * run;
+    }
+    const auto mid = lo + (hi - lo) / 2;
+    return range_product(lo, mid) * range_product(mid + 1, hi);
+}
+
+BigUnsigned big_factorial(int number) {
+    if (number < 0) throw std::range_error{ "Given number too low!" };
+    if (static_cast<size_t>(number) < factorial_table.size()) return factorial_table[static_cast<size_t>(number)];
+    return range_product(2, static_cast<uint64_t>(number));
 }
 
-TEST_CASE("Factorials are computed", "[factorial]") {
-    REQUIRE( Factorial(0) == 1);
-    REQUIRE( Factorial(1) == 1 );
-    REQUIRE( Factorial(2) == 2 );
-    REQUIRE( Factorial(3) == 6 );
-    REQUIRE( Factorial(10) == 3628800 );
+// The same [factorial] checks run against every mode
+struct IntMode { static int compute(int n) { return Factorial(n); } };
+struct CheckedMode { static uint64_t compute(int n) { return factorial_as<uint64_t>(n); } };
+struct BigMode { static BigUnsigned compute(int n) { return big_factorial(n); } };
+
+TEMPLATE_TEST_CASE("Factorials are computed", "[factorial]", IntMode, CheckedMode, BigMode) {
+    REQUIRE( TestType::compute(0) == 1);
+    REQUIRE( TestType::compute(1) == 1 );
+    REQUIRE( TestType::compute(2) == 2 );
+    REQUIRE( TestType::compute(3) == 6 );
+    REQUIRE( TestType::compute(10) == 3628800 );
+}
+
+TEST_CASE("Factorial overflow and big factorials", "[factorial]") {
+    SECTION("the checked modes throw instead of wrapping") {
+        REQUIRE( Factorial(12) == 479001600 );
+        REQUIRE_THROWS_AS( Factorial(13), std::overflow_error );
+        REQUIRE( factorial_as<uint64_t>(20) == 2432902008176640000ULL );
+        REQUIRE_THROWS_AS( factorial_as<uint64_t>(21), std::overflow_error );
+        REQUIRE_THROWS_AS( factorial_as<uint8_t>(6), std::overflow_error );
+    }
+    SECTION("big_factorial agrees with the table and keeps going") {
+        for (int n{}; n <= 20; n++) {
+            REQUIRE( big_factorial(n) == factorial_table[static_cast<size_t>(n)] );
+        }
+        REQUIRE( big_factorial(25).to_string() == "15511210043330985984000000" );
+        const auto hundred = big_factorial(100).to_string();
+        REQUIRE( hundred.size() == 158 );
+        REQUIRE( hundred.substr(0, 12) == "933262154439" );
+    }
+    SECTION("the product tree matches one-by-one multiplication") {
+        BigUnsigned sequential{ 1 };
+        for (uint64_t k { 2 }; k <= 3000; k++) sequential = sequential * k;
+        const auto tree = big_factorial(3000);
+        REQUIRE( tree == sequential );
+        const auto digits = tree.to_string();
+        REQUIRE( digits.size() == 9131 );
+        REQUIRE( digits.size() - digits.find_last_not_of('0') - 1 == 748 );  // floor(3000/5) + floor(3000/25) + ...
+    }
 }
 
 SCENARIO("BDD-style factorials", "[factorial]") {
@@ -46,7 +276,51 @@ SCENARIO("BDD-style factorials", "[factorial]") {
         WHEN("I pass in a negative number") {
             THEN("An Error is thrown") { 
                 REQUIRE_THROWS( Factorial(-1) );
+                REQUIRE_THROWS( factorial_as<uint64_t>(-1) );
+                REQUIRE_THROWS( big_factorial(-1) );
             }
         }
     }
+}
+
+/*
+    Factorial costs per mode; the recursive int version is the one Factorial used to be.
+    Hidden by the leading dot; run with: ./ccc-10 "[.benchmark]"
+*/
+TEST_CASE("Factorial modes", "[.benchmark]") {
+    auto time = [](const char* name, int repeats, auto&& run) {
+        uint64_t check{};
+        const auto start = std::chrono::steady_clock::now();
+        for (int i{}; i < repeats; i++) check += run(i);
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-40s %12.1f ns/call (check %llu)\n", name, elapsed.count() / repeats, static_cast<unsigned long long>(check));
+    };
+    volatile int spread { 13 };  // keep the compiler from folding the arguments
+    auto recursive = [](auto& self, uint64_t n) -> uint64_t { return n <= 1 ? 1 : self(self, n - 1) * n; };
+    time("recursive uint64_t", 10'000'000, [&](int i) { return recursive(recursive, static_cast<uint64_t>(i % spread + 8)); });
+    time("factorial_as<uint64_t> (table)", 10'000'000, [&](int i) { return factorial_as<uint64_t>(i % spread + 8); });
+    for (uint64_t n : { 1000, 10000, 30000 }) {
+        const auto repeats = n > 10000 ? 1 : 10;
+        char name[64];
+        snprintf(name, sizeof(name), "%llu! one by one", static_cast<unsigned long long>(n));
+        time(name, repeats, [&](int) {
+            BigUnsigned product{ 1 };
+            for (uint64_t k { 2 }; k <= n; k++) product = product * k;
+            return product.bits();
+        });
+        snprintf(name, sizeof(name), "%llu! product tree (big_factorial)", static_cast<unsigned long long>(n));
+        time(name, repeats, [&](int) { return big_factorial(static_cast<int>(n)).bits(); });
+    }
+}
+
+/*
+    Catch2 BENCHMARK versions of the factorial modes (warm-up, samples, mean and standard deviation), hidden by
+    [!benchmark]. For results to compare between commits: ./ccc-10 "[!benchmark]" -r xml -o ccc-10-benchmarks.xml
+*/
+TEST_CASE("Factorial benchmarks", "[!benchmark]") {
+    const auto n = static_cast<int>(std::chrono::steady_clock::now().time_since_epoch().count() % 2) + 11;
+    BENCHMARK("Factorial(n) (table)") { return Factorial(n); };
+    BENCHMARK("factorial_as<uint64_t>(n + 8) (table)") { return factorial_as<uint64_t>(n + 8); };
+    BENCHMARK("big_factorial(1000)") { return big_factorial(1000 + n % 2).bits(); };
+    BENCHMARK("big_factorial(1000).to_string()") { return big_factorial(1000).to_string().size(); };
 }
\ No newline at end of file
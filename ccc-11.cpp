@@ -9,10 +9,18 @@
  *   5. Intrusive
 */
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 #include <boost/smart_ptr/scoped_ptr.hpp>
 #include <boost/smart_ptr/scoped_array.hpp>
 #include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <thread>
 
 struct DeadMenOfDunharrow {
     DeadMenOfDunharrow(const char* m="")
@@ -229,4 +237,331 @@ TEST_CASE("WEAK POINTERS: ") {
             REQUIRE(shared_ptr == nullptr);
         }
     }
+}
+
+/*
+ * INTRUSIVE POINTERS
+ *  The reference count lives inside the object, so there is no separate control block: an IntrusivePtr is one raw
+ *  pointer, make_intrusive is one allocation, and a raw pointer to the object can be turned back into an owner.
+ *  Objects opt in by deriving from RefCounted<Self, CountPolicy> (CRTP, so release() deletes the right type):
+ *   - AtomicCount: safe to share across threads, the same cost model as std::shared_ptr
+ *   - PlainCount: an ordinary integer for objects that never leave one thread - no locked instructions at all
+ *  No weak references: the count and the object die together.
+*/
+struct AtomicCount {
+    void increment() { count.fetch_add(1, std::memory_order_relaxed); }
+    // acq_rel: the thread that drops the last reference must see every other owner's writes before deleting
+    bool decrement() { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    uint32_t value() const { return count.load(std::memory_order_relaxed); }
+private:
+    std::atomic<uint32_t> count{};
+};
+
+struct PlainCount {
+    void increment() { count++; }
+    bool decrement() { return --count == 0; }
+    uint32_t value() const { return count; }
+private:
+    uint32_t count{};
+};
+
+template <typename Derived, typename CountPolicy = AtomicCount>
+struct RefCounted {
+    void add_ref() const { references.increment(); }
+    void release() const {
+        if (references.decrement()) delete static_cast<const Derived*>(this);
+    }
+    uint32_t use_count() const { return references.value(); }
+
+protected:
+    RefCounted() = default;
+    RefCounted(const RefCounted&) { }  // a copy of the object is a new object with its own owners
+    RefCounted& operator=(const RefCounted&) { return *this; }
+    ~RefCounted() = default;
+
+private:
+    mutable CountPolicy references;
+};
+
+template <typename T>
+struct IntrusivePtr {
+    IntrusivePtr() = default;
+    // Takes a reference: IntrusivePtr{ new T } and IntrusivePtr{ existing.get() } are both fine
+    explicit IntrusivePtr(T* pointer) : pointer{ pointer } {
+        if (pointer) pointer->add_ref();
+    }
+    IntrusivePtr(const IntrusivePtr& other) : IntrusivePtr{ other.pointer } { }
+    IntrusivePtr(IntrusivePtr&& other) noexcept : pointer{ other.pointer } { other.pointer = nullptr; }
+    IntrusivePtr& operator=(IntrusivePtr other) noexcept {  // copy-and-swap covers both copy and move
+        std::swap(pointer, other.pointer);
+        return *this;
+    }
+    ~IntrusivePtr() {
+        if (pointer) pointer->release();
+    }
+
+    void reset() { IntrusivePtr{}.swap(*this); }
+    void swap(IntrusivePtr& other) noexcept { std::swap(pointer, other.pointer); }
+
+    T* get() const { return pointer; }
+    T& operator*() const { return *pointer; }
+    T* operator->() const { return pointer; }
+    explicit operator bool() const { return pointer != nullptr; }
+    uint32_t use_count() const { return pointer ? pointer->use_count() : 0; }
+    bool operator==(const IntrusivePtr& other) const { return pointer == other.pointer; }
+
+private:
+    T* pointer{};
+};
+
+template <typename T, typename... Args>
+IntrusivePtr<T> make_intrusive(Args&&... args) {
+    return IntrusivePtr<T>{ new T(std::forward<Args>(args)...) };
+}
+
+template <typename CountPolicy>
+struct IntrusiveOathBreaker : DeadMenOfDunharrow, RefCounted<IntrusiveOathBreaker<CountPolicy>, CountPolicy> {
+    using DeadMenOfDunharrow::DeadMenOfDunharrow;
+};
+
+TEMPLATE_TEST_CASE("INTRUSIVE POINTERS: ", "", AtomicCount, PlainCount) {
+    using IntrusiveOathBreakers = IntrusivePtr<IntrusiveOathBreaker<TestType>>;
+    static_assert(sizeof(IntrusiveOathBreakers) == sizeof(void*));
+
+    SECTION("IntrusivePtr can be used in copy") {
+        auto aragorn = make_intrusive<IntrusiveOathBreaker<TestType>>();
+        SECTION("construction") {
+            auto son_of_arathorn { aragorn };
+            REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 1);
+            REQUIRE(aragorn.use_count() == 2);
+        }
+        SECTION("assignment, and original gets discarded") {
+            auto son_of_arathorn = make_intrusive<IntrusiveOathBreaker<TestType>>();
+            REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 2);
+            son_of_arathorn = aragorn;
+            REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 1);
+            REQUIRE(son_of_arathorn == aragorn);
+        }
+        SECTION("move, which leaves the count alone") {
+            auto son_of_arathorn { std::move(aragorn) };
+            REQUIRE(son_of_arathorn.use_count() == 1);
+            REQUIRE_FALSE(aragorn);
+        }
+        SECTION("a raw pointer becomes an owner again") {
+            IntrusiveOathBreakers from_raw { aragorn.get() };
+            REQUIRE(aragorn.use_count() == 2);
+            aragorn.reset();
+            REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 1);
+        }
+    }
+    SECTION("the last owner destroys the object") {
+        {
+            auto aragorn = make_intrusive<IntrusiveOathBreaker<TestType>>("The way is shut.");
+            auto legolas = aragorn;
+            aragorn.reset();
+            REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 1);
+            REQUIRE(legolas->message == std::string_view{ "The way is shut." });
+        }
+        REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 0);
+    }
+}
+
+/*
+ * POOLED CONTROL BLOCKS
+ *  std::make_shared already puts the control block and the object in one allocation; std::allocate_shared lets us
+ *  pick where that allocation comes from. PoolAllocator serves single-object allocations from SlabPool, a
+ *  fixed-block version of the ccc-7.cpp Heap: 64 KiB slabs carved into equal blocks, freed blocks kept on an
+ *  intrusive free list (the first bytes of a free block point to the next one). Shared objects of one type end
+ *  up packed next to each other instead of scattered through the general-purpose heap.
+ *  Like the Heap in SingleThreaded mode, a pool must only be used from one thread.
+*/
+class SlabPool {
+public:
+    static const size_t slab_size { 64 * 1024 };
+
+    explicit SlabPool(size_t block_size) : block_size{ (block_size + 15) / 16 * 16 } { }
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    void* allocate() {
+        if (free_list) {
+            const auto block = free_list;
+            free_list = *static_cast<void**>(block);
+            in_use++;
+            live_blocks++;
+            return block;
+        }
+        if (carved == blocks_per_slab() || slabs.empty()) {
+            slabs.push_back(std::make_unique<std::byte[]>(slab_size));
+            carved = 0;
+        }
+        in_use++;
+        live_blocks++;
+        return slabs.back().get() + block_size * carved++;
+    }
+
+    void deallocate(void* block) {
+        *static_cast<void**>(block) = free_list;
+        free_list = block;
+        in_use--;
+        live_blocks--;
+    }
+
+    static inline size_t live_blocks{};  // across every pool
+
+    size_t blocks_in_use() const { return in_use; }
+    size_t slab_count() const { return slabs.size(); }
+
+private:
+    size_t blocks_per_slab() const { return slab_size / block_size; }
+
+    const size_t block_size;
+    std::vector<std::unique_ptr<std::byte[]>> slabs;
+    size_t carved{}, in_use{};
+    void* free_list{};
+};
+
+// One pool per block size, shared by every type that rounds to it
+template <size_t BlockSize>
+SlabPool& block_pool() {
+    static SlabPool pool { BlockSize };
+    return pool;
+}
+
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+    // Slabs come from new std::byte[], which guarantees the default new alignment; anything stricter is left to std::allocator
+    static constexpr bool pooled { alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ && sizeof(T) <= SlabPool::slab_size };
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) { }
+
+    static SlabPool& pool() { return block_pool<(sizeof(T) + 15) / 16 * 16>(); }
+
+    T* allocate(size_t n) {
+        if (!pooled || n != 1) return std::allocator<T>{}.allocate(n);
+        return static_cast<T*>(pool().allocate());
+    }
+    void deallocate(T* p, size_t n) {
+        if (!pooled || n != 1) return std::allocator<T>{}.deallocate(p, n);
+        pool().deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const { return true; }
+};
+
+TEST_CASE("POOLED SHARED POINTERS: ") {
+    // allocate_shared rebinds the allocator to its internal control block type, so count blocks across all pools
+    const PoolAllocator<DeadMenOfDunharrow> allocator;
+    const auto blocks_before = SlabPool::live_blocks;
+
+    SECTION("allocate_shared constructs and destroys like make_shared") {
+        {
+            auto aragorn = std::allocate_shared<DeadMenOfDunharrow>(allocator, "The way is shut.");
+            auto legolas = aragorn;
+            REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 1);
+            REQUIRE(aragorn.use_count() == 2);
+            REQUIRE(legolas->message == std::string_view{ "The way is shut." });
+            REQUIRE(SlabPool::live_blocks == blocks_before + 1);  // object and control block share one block
+        }
+        REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 0);
+        REQUIRE(SlabPool::live_blocks == blocks_before);
+    }
+    SECTION("control blocks are recycled through the pool") {
+        std::vector<std::shared_ptr<DeadMenOfDunharrow>> army;
+        for (int i{}; i < 1000; i++) army.push_back(std::allocate_shared<DeadMenOfDunharrow>(allocator));
+        const auto first = army.front().get();
+        // neighbours in creation order are neighbours in memory
+        const auto stride = reinterpret_cast<std::byte*>(army[1].get()) - reinterpret_cast<std::byte*>(first);
+        REQUIRE(stride > 0);
+        REQUIRE(stride <= 64);
+        const auto last = army.back().get();
+        army.clear();
+        REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 0);
+        REQUIRE(SlabPool::live_blocks == blocks_before);
+        auto again = std::allocate_shared<DeadMenOfDunharrow>(allocator);
+        REQUIRE(again.get() == last);  // the most recently freed block comes back first
+    }
+    SECTION("a weak pointer keeps the block, not the object") {
+        std::weak_ptr<DeadMenOfDunharrow> legolas;
+        {
+            auto aragorn = std::allocate_shared<DeadMenOfDunharrow>(allocator);
+            legolas = aragorn;
+        }
+        REQUIRE(DeadMenOfDunharrow::oaths_to_fufill == 0);
+        REQUIRE(legolas.expired());
+        REQUIRE(SlabPool::live_blocks == blocks_before + 1);
+        legolas.reset();
+        REQUIRE(SlabPool::live_blocks == blocks_before);
+    }
+}
+
+/*
+ * SMART POINTER BENCHMARKS: what each ownership model costs per object. make_shared puts the control block and
+ *  the object in one allocation; shared_ptr copies pay for an atomic increment and decrement.
+ *  Hidden by [!benchmark]; run with ./ccc-11 "[!benchmark]" -r xml -o ccc-11-benchmarks.xml for machine-readable
+ *  results (mean and standard deviation per benchmark, in ns).
+*/
+TEST_CASE("Smart pointer benchmarks", "[!benchmark]") {
+    const char* message = "The way is shut.";
+
+    // keep_memory stops the compiler from eliding a new/delete pair whose object nobody looks at
+    BENCHMARK("new + delete") {
+        auto raw = new DeadMenOfDunharrow{ message };
+        Catch::Benchmark::keep_memory(raw);
+        delete raw;
+    };
+    BENCHMARK("boost::scoped_ptr") {
+        ScopedOathBreakers aragorn{ new DeadMenOfDunharrow{ message } };
+        Catch::Benchmark::keep_memory(aragorn.get());
+    };
+    BENCHMARK("std::make_unique") { return std::make_unique<DeadMenOfDunharrow>(message); };
+    BENCHMARK("std::shared_ptr(new T) (two allocations)") { return std::shared_ptr<DeadMenOfDunharrow>(new DeadMenOfDunharrow{ message }); };
+    BENCHMARK("std::make_shared (one allocation)") { return std::make_shared<DeadMenOfDunharrow>(message); };
+
+    auto unique = std::make_unique<DeadMenOfDunharrow>(message);
+    BENCHMARK("std::unique_ptr move") {
+        auto moved = std::move(unique);
+        unique = std::move(moved);
+        return unique.get();
+    };
+    const auto shared = std::make_shared<DeadMenOfDunharrow>(message);
+    BENCHMARK("std::shared_ptr copy") {
+        auto copy = shared;
+        return copy.use_count();
+    };
+    const std::weak_ptr<DeadMenOfDunharrow> weak{ shared };
+    BENCHMARK("std::weak_ptr::lock") { return weak.lock(); };
+
+    BENCHMARK("std::allocate_shared with PoolAllocator") {
+        return std::allocate_shared<DeadMenOfDunharrow>(PoolAllocator<DeadMenOfDunharrow>{}, message);
+    };
+    BENCHMARK("make_intrusive<AtomicCount>") { return make_intrusive<IntrusiveOathBreaker<AtomicCount>>(message); };
+    BENCHMARK("make_intrusive<PlainCount>") { return make_intrusive<IntrusiveOathBreaker<PlainCount>>(message); };
+    const auto atomic_intrusive = make_intrusive<IntrusiveOathBreaker<AtomicCount>>(message);
+    const auto plain_intrusive = make_intrusive<IntrusiveOathBreaker<PlainCount>>(message);
+    BENCHMARK("IntrusivePtr<AtomicCount> copy") { return IntrusivePtr{ atomic_intrusive }.use_count(); };
+    BENCHMARK("IntrusivePtr<PlainCount> copy") { return IntrusivePtr{ plain_intrusive }.use_count(); };
+
+    // Copy/destroy throughput: fill 1000 owners of one object, then drop them all
+    auto copies = [](const auto& original) {
+        std::vector<std::decay_t<decltype(original)>> owners(1000, original);
+        return owners.back().use_count();
+    };
+    BENCHMARK("1000 std::shared_ptr copies + destroys") { return copies(shared); };
+    BENCHMARK("1000 IntrusivePtr<AtomicCount> copies + destroys") { return copies(atomic_intrusive); };
+    BENCHMARK("1000 IntrusivePtr<PlainCount> copies + destroys") { return copies(plain_intrusive); };
+
+    // libstdc++ skips the atomic instructions while the process has only ever had one thread (Catch runs
+    // single-threaded), so the numbers above flatter std::shared_ptr. Once any thread has started it pays like
+    // AtomicCount does. This has to stay last: the process can't go back to single-threaded.
+    std::thread{ [] { }}.join();
+    BENCHMARK("std::shared_ptr copy, after a thread started") {
+        auto copy = shared;
+        return copy.use_count();
+    };
+    BENCHMARK("1000 std::shared_ptr copies + destroys, after a thread started") { return copies(shared); };
 }
\ No newline at end of file
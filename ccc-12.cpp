@@ -1,4 +1,5 @@
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 #include <boost/logic/tribool.hpp>
 #include <optional>
@@ -10,6 +11,18 @@
 #include <boost/math/constants/constants.hpp>
 #include <random>
 #include <ratio>
+#include <cstdint>
+#include <span>
+#include <array>
+#include <vector>
+#include <bit>
+#include <concepts>
+#include <algorithm>
+#include <limits>
+// Xoshiro256ssx4::fill and Pcg32::fill use AVX2 when built with -mavx2
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 /*
     tribool: can be either true, false, or indeterminate. Good for checking intermediate state of system.
@@ -202,6 +215,346 @@ TEST_CASE("Evaluation of cmath and Boost mathematical constants") {
         - pseudorandom: provides a reproducable series of seemingly random numbers based on a seed
         - cryptographically random: closer to true random number generation
 */
+/*
+    Small-state engines for hot paths. mt19937_64 carries 2.5 KB of state, which adds up when every worker thread
+    needs its own copy. These carry 8 to 32 bytes, and all of them are UniformRandomBitGenerators, so they plug into
+    the std distributions:
+        - Xoshiro256ss (xoshiro256**): 64-bit output, period 2^256 - 1. jump() skips 2^128 draws, long_jump() 2^192.
+        - Pcg32: 32-bit output from a 64-bit LCG. advance(n) skips n draws in O(log n).
+        - Wyrand: 64-bit output from a Weyl counter, so advance(n) is one multiply-add.
+    Every engine has jump(), which moves far enough ahead that streams don't overlap in practice (2^128 for xoshiro,
+    2^48 for the 2^64-period engines). make_streams(seed, n) hands out n such streams, one per thread.
+
+    fill(span) writes exactly what the same number of operator() calls would. xoshiro is one serial dependency chain
+    and can't be split that way, so Xoshiro256ssx4 runs four jumped xoshiro streams side by side in SIMD lanes
+    instead; its fill is the vectorized bulk path for 64-bit values.
+*/
+namespace prng {
+    // SplitMix64 is only used to expand a single seed into a full engine state
+    constexpr uint64_t splitmix64(uint64_t& x) {
+        auto z = (x += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    class Xoshiro256ss {
+    public:
+        using result_type = uint64_t;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        constexpr explicit Xoshiro256ss(uint64_t seed = 0x9E3779B97F4A7C15) {
+            for (auto& word : s) word = splitmix64(seed);
+        }
+
+        constexpr result_type operator()() {
+            const auto result = std::rotl(s[1] * 5, 7) * 9;
+            const auto t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = std::rotl(s[3], 45);
+            return result;
+        }
+
+        // a local copy: out is uint64_t too, so the member state could alias it and would stay in memory
+        void fill(std::span<result_type> out) {
+            auto local = *this;
+            for (auto& value : out) value = local();
+            *this = local;
+        }
+
+        constexpr void jump() { apply_jump({ 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c }); }
+        constexpr void long_jump() { apply_jump({ 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 }); }
+
+        constexpr const std::array<uint64_t, 4>& state() const { return s; }
+        friend constexpr bool operator==(const Xoshiro256ss&, const Xoshiro256ss&) = default;
+
+    private:
+        // the jump polynomial: XOR together the states at the positions of its set bits
+        constexpr void apply_jump(std::array<uint64_t, 4> polynomial) {
+            std::array<uint64_t, 4> jumped {};
+            for (const auto word : polynomial) {
+                for (int bit {}; bit < 64; bit++) {
+                    if (word & (uint64_t{ 1 } << bit)) {
+                        for (int i {}; i < 4; i++) jumped[i] ^= s[i];
+                    }
+                    (*this)();
+                }
+            }
+            s = jumped;
+        }
+
+        std::array<uint64_t, 4> s {};
+    };
+
+    class Pcg32 {
+    public:
+        using result_type = uint32_t;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+        static constexpr uint64_t multiplier { 6364136223846793005 };
+
+        // same seeding as the reference pcg32_srandom_r: stream picks one of 2^63 distinct sequences
+        constexpr explicit Pcg32(uint64_t seed = 0x853c49e6748fea9b, uint64_t stream = 0xda3e39cb94b95bdb)
+            : increment { (stream << 1) | 1 } {
+            step();
+            state += seed;
+            step();
+        }
+
+        constexpr result_type operator()() {
+            const auto old = state;
+            step();
+            return output(old);
+        }
+
+        // skips delta draws by composing the LCG with itself (Brown, "Random Number Generation with Arbitrary Strides")
+        constexpr void advance(uint64_t delta) {
+            uint64_t mult { multiplier }, plus { increment }, total_mult { 1 }, total_plus {};
+            for (; delta; delta >>= 1) {
+                if (delta & 1) {
+                    total_mult *= mult;
+                    total_plus = total_plus * mult + plus;
+                }
+                plus = (mult + 1) * plus;
+                mult *= mult;
+            }
+            state = total_mult * state + total_plus;
+        }
+
+        constexpr void jump() { advance(uint64_t{ 1 } << 48); }
+
+        void fill(std::span<result_type> out);
+
+        friend constexpr bool operator==(const Pcg32&, const Pcg32&) = default;
+
+    private:
+        static constexpr result_type output(uint64_t old) {
+            return std::rotr(static_cast<uint32_t>(((old >> 18) ^ old) >> 27), static_cast<int>(old >> 59));
+        }
+        constexpr void step() { state = state * multiplier + increment; }
+
+        uint64_t state {};
+        uint64_t increment {};
+    };
+
+#if defined(__AVX2__)
+    // low 64 bits of a 64 x 64-bit product per lane; AVX2 only multiplies 32 x 32 -> 64
+    inline __m256i mullo_epi64(__m256i a, __m256i b) {
+        const auto low = _mm256_mul_epu32(a, b);
+        const auto cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                            _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+    }
+#endif
+
+    /*
+        An LCG can leapfrog: lane k starts k steps in and every lane then strides 8 steps at a time (the LCG composed
+        with itself 8 times), so the eight lanes together produce exactly the serial sequence, eight draws at a time.
+    */
+    inline void Pcg32::fill(std::span<result_type> out) {
+        size_t i {};
+#if defined(__AVX2__)
+        if (out.size() >= 16) {
+            alignas(32) uint64_t lanes[8];
+            auto lane = *this;
+            for (auto& old : lanes) {
+                old = lane.state;
+                lane.step();
+            }
+            auto stride = Pcg32{ *this };
+            stride.state = 0;
+            stride.advance(8);  // from state 0, 8 steps land on total_plus
+            const auto plus8 = _mm256_set1_epi64x(static_cast<long long>(stride.state));
+            uint64_t mult8 { multiplier };
+            for (int k {}; k < 3; k++) mult8 *= mult8;
+            const auto mult8v = _mm256_set1_epi64x(static_cast<long long>(mult8));
+            const auto low32 = _mm256_set1_epi64x(0xFFFFFFFF);
+            const auto thirty_two = _mm256_set1_epi64x(32);
+            const auto gather_low = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+            auto first = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes));
+            auto second = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes + 4));
+            auto permute = [&](__m256i old) {
+                const auto xorshifted = _mm256_and_si256(
+                    _mm256_srli_epi64(_mm256_xor_si256(_mm256_srli_epi64(old, 18), old), 27), low32);
+                const auto rot = _mm256_srli_epi64(old, 59);
+                const auto rotated = _mm256_or_si256(_mm256_srlv_epi64(xorshifted, rot),
+                                                     _mm256_sllv_epi64(xorshifted, _mm256_sub_epi64(thirty_two, rot)));
+                // sllv by 32 (rot == 0) leaves bits above 31 only, so the 32-bit picks below drop them
+                return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(rotated, gather_low));
+            };
+            for (; i + 8 <= out.size(); i += 8) {
+                const auto results = _mm256_set_m128i(permute(second), permute(first));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.data() + i), results);
+                first = _mm256_add_epi64(mullo_epi64(first, mult8v), plus8);
+                second = _mm256_add_epi64(mullo_epi64(second, mult8v), plus8);
+            }
+            state = static_cast<uint64_t>(_mm256_extract_epi64(first, 0));
+        }
+#endif
+        for (; i < out.size(); i++) out[i] = (*this)();
+    }
+
+    class Wyrand {
+    public:
+        using result_type = uint64_t;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+        static constexpr uint64_t increment { 0xa0761d6478bd642f };
+
+        constexpr explicit Wyrand(uint64_t seed = 0) : state { seed } { }
+
+        constexpr result_type operator()() { return mix(state += increment); }
+
+        constexpr void advance(uint64_t delta) { state += delta * increment; }
+        constexpr void jump() { advance(uint64_t{ 1 } << 48); }
+
+        // draw i only depends on state + (i + 1) * increment, so there's no chain and the multiplies overlap freely
+        void fill(std::span<result_type> out) {
+            const auto base = state;
+            for (size_t i {}; i < out.size(); i++) out[i] = mix(base + (i + 1) * increment);
+            advance(out.size());
+        }
+
+        friend constexpr bool operator==(const Wyrand&, const Wyrand&) = default;
+
+    private:
+        static constexpr uint64_t mix(uint64_t x) {
+            const auto product = static_cast<unsigned __int128>(x) * (x ^ 0xe7037ed1a0b428db);
+            return static_cast<uint64_t>(product >> 64) ^ static_cast<uint64_t>(product);
+        }
+
+        uint64_t state {};
+    };
+
+    /*
+        Four xoshiro256** streams, each one jump() after the previous, kept structure-of-arrays so each word of
+        state is one SIMD register. 5x and 9x are shift-adds, which AVX2 has for 64-bit lanes. Output is interleaved:
+        value 4j + k is lane k's j-th draw.
+    */
+    class Xoshiro256ssx4 {
+    public:
+        using result_type = uint64_t;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        explicit Xoshiro256ssx4(Xoshiro256ss seed = Xoshiro256ss{}) {
+            for (int lane {}; lane < 4; lane++) {
+                for (int word {}; word < 4; word++) s[word][lane] = seed.state()[word];
+                seed.jump();
+            }
+        }
+
+        result_type operator()() {
+            if (buffered == 4) {
+                next4(buffer);
+                buffered = 0;
+            }
+            return buffer[buffered++];
+        }
+
+        // a tail that isn't a multiple of four still advances all four lanes by one draw
+        void fill(std::span<result_type> out) {
+            size_t i {};
+            for (; i + 4 <= out.size(); i += 4) next4(out.data() + i);
+            if (i < out.size()) {
+                uint64_t tail[4];
+                next4(tail);
+                for (size_t k {}; i < out.size(); i++, k++) out[i] = tail[k];
+            }
+        }
+
+    private:
+        void next4(uint64_t* out) {
+#if defined(__AVX2__)
+            auto load = [&](int word) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(s[word])); };
+            auto rotl = [](__m256i x, int k) { return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k)); };
+            auto s0 = load(0), s1 = load(1), s2 = load(2), s3 = load(3);
+            const auto times5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+            const auto rotated = rotl(times5, 7);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated));
+            const auto t = _mm256_slli_epi64(s1, 17);
+            s2 = _mm256_xor_si256(s2, s0);
+            s3 = _mm256_xor_si256(s3, s1);
+            s1 = _mm256_xor_si256(s1, s2);
+            s0 = _mm256_xor_si256(s0, s3);
+            s2 = _mm256_xor_si256(s2, t);
+            s3 = rotl(s3, 45);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(s[0]), s0);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(s[1]), s1);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(s[2]), s2);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(s[3]), s3);
+#else
+            for (int lane {}; lane < 4; lane++) {
+                out[lane] = std::rotl(s[1][lane] * 5, 7) * 9;
+                const auto t = s[1][lane] << 17;
+                s[2][lane] ^= s[0][lane];
+                s[3][lane] ^= s[1][lane];
+                s[1][lane] ^= s[2][lane];
+                s[0][lane] ^= s[3][lane];
+                s[2][lane] ^= t;
+                s[3][lane] = std::rotl(s[3][lane], 45);
+            }
+#endif
+        }
+
+        alignas(32) uint64_t s[4][4] {};
+        uint64_t buffer[4] {};
+        size_t buffered { 4 };
+    };
+
+    // n non-overlapping streams, e.g. one per worker thread
+    template <typename Engine>
+    std::vector<Engine> make_streams(Engine engine, size_t n) {
+        std::vector<Engine> streams;
+        streams.reserve(n);
+        for (size_t i {}; i < n; i++) {
+            streams.push_back(engine);
+            engine.jump();
+        }
+        return streams;
+    }
+
+    static_assert(std::uniform_random_bit_generator<Xoshiro256ss> && std::uniform_random_bit_generator<Pcg32> &&
+                  std::uniform_random_bit_generator<Wyrand> && std::uniform_random_bit_generator<Xoshiro256ssx4>);
+    static_assert(sizeof(Xoshiro256ss) == 32 && sizeof(Pcg32) == 16 && sizeof(Wyrand) == 8);
+}
+
+// Smoke tests only (TestU01 / PractRand are the real thing), all with fixed seeds so they can't flake
+template <typename Engine>
+void require_statistically_plausible(Engine engine) {
+    using result_type = typename Engine::result_type;
+    const int bits { std::numeric_limits<result_type>::digits };
+    const size_t n { 1 << 16 };
+    std::vector<size_t> ones(bits);
+    std::array<size_t, 256> buckets {};
+    double previous {}, sum {}, sum_squares {}, sum_products {};
+    for (size_t i {}; i < n; i++) {
+        const auto value = engine();
+        for (int bit {}; bit < bits; bit++) ones[bit] += (value >> bit) & 1;
+        buckets[value >> (bits - 8)]++;
+        const auto unit = static_cast<double>(value) / static_cast<double>(Engine::max());
+        sum += unit;
+        sum_squares += unit * unit;
+        sum_products += unit * previous;
+        previous = unit;
+    }
+    // monobit: each bit set half the time, within 5 standard deviations (sqrt(n) / 2 = 128)
+    for (int bit {}; bit < bits; bit++) REQUIRE(std::abs(static_cast<double>(ones[bit]) - n / 2.0) < 5 * 128);
+    // chi-square over the top byte: 255 degrees of freedom, the 99.99th percentile is about 346
+    double chi_square {};
+    for (const auto count : buckets) chi_square += std::pow(count - n / 256.0, 2) / (n / 256.0);
+    REQUIRE(chi_square < 346);
+    // lag-1 serial correlation of uniform doubles: expected 0 with standard deviation 1 / sqrt(n)
+    const auto mean = sum / n, variance = sum_squares / n - mean * mean;
+    REQUIRE(std::abs((sum_products / n - mean * mean) / variance) < 5 / std::sqrt(n));
+    REQUIRE(mean == Approx(0.5).epsilon(0.01));
+}
+
 TEST_CASE("Random Number Generation Engines") {
     SECTION("mt19937_64 is psedorandom") {
         std::mt19937_64 mt_engine { 91586 };
@@ -216,6 +569,87 @@ TEST_CASE("Random Number Generation Engines") {
 
         REQUIRE_NOTHROW(rd_engine());
     }
+
+    SECTION("Pcg32 matches the reference implementation") {
+        // pcg32-demo output for pcg32_srandom(42, 54)
+        prng::Pcg32 pcg { 42, 54 };
+        for (const uint32_t expected : { 0xa15c02b7u, 0x7b47f409u, 0xba1d3330u, 0x83d2f293u, 0xbfa4784bu, 0xcbed606eu }) {
+            REQUIRE(pcg() == expected);
+        }
+    }
+
+    SECTION("small-state engines work with the std distributions") {
+        prng::Xoshiro256ss xoshiro { 91586 };
+        std::uniform_int_distribution<int> die { 1, 6 };
+        for (int i {}; i < 1000; i++) {
+            const auto roll = die(xoshiro);
+            REQUIRE(roll >= 1);
+            REQUIRE(roll <= 6);
+        }
+    }
+
+    SECTION("advance and jump skip ahead exactly") {
+        prng::Pcg32 leaped { 91586 }, stepped { 91586 };
+        leaped.advance(12345);
+        for (int i {}; i < 12345; i++) stepped();
+        REQUIRE(leaped == stepped);
+
+        prng::Wyrand wy_leaped { 91586 }, wy_stepped { 91586 };
+        wy_leaped.advance(777);
+        for (int i {}; i < 777; i++) wy_stepped();
+        REQUIRE(wy_leaped == wy_stepped);
+
+        // jump() is linear over GF(2): jumping then drawing once equals drawing once then jumping
+        prng::Xoshiro256ss a { 91586 }, b { 91586 };
+        a.jump();
+        a();
+        b();
+        b.jump();
+        REQUIRE(a == b);
+        REQUIRE_FALSE(a == prng::Xoshiro256ss { 91586 });
+    }
+
+    SECTION("make_streams gives every thread a distinct stream") {
+        const auto streams = prng::make_streams(prng::Xoshiro256ss { 91586 }, 8);
+        std::vector<uint64_t> firsts;
+        for (auto stream : streams) firsts.push_back(stream());
+        std::sort(firsts.begin(), firsts.end());
+        REQUIRE(std::adjacent_find(firsts.begin(), firsts.end()) == firsts.end());
+    }
+
+    SECTION("fill matches repeated calls") {
+        for (const size_t n : { 0, 1, 7, 8, 15, 16, 17, 1000 }) {
+            prng::Pcg32 filled { 91586 }, called { 91586 };
+            std::vector<uint32_t> pcg_out(n);
+            filled.fill(pcg_out);
+            for (const auto value : pcg_out) REQUIRE(value == called());
+            REQUIRE(filled == called);
+
+            prng::Wyrand wy_filled { 91586 }, wy_called { 91586 };
+            std::vector<uint64_t> wy_out(n);
+            wy_filled.fill(wy_out);
+            for (const auto value : wy_out) REQUIRE(value == wy_called());
+            REQUIRE(wy_filled == wy_called);
+        }
+    }
+
+    SECTION("Xoshiro256ssx4 interleaves four jumped xoshiro256** streams") {
+        auto lanes = prng::make_streams(prng::Xoshiro256ss { 91586 }, 4);
+        prng::Xoshiro256ssx4 wide { prng::Xoshiro256ss { 91586 } };
+        std::vector<uint64_t> out(402);
+        wide.fill(out);
+        for (size_t i {}; i < out.size(); i++) REQUIRE(out[i] == lanes[i % 4]());
+        // the two-value tail advanced all four lanes, so the next call starts a fresh group of four at lane 0
+        REQUIRE(wide() == lanes[0]());
+        REQUIRE(wide() == lanes[1]());
+    }
+
+    SECTION("small-state engines pass statistical smoke tests") {
+        require_statistically_plausible(prng::Xoshiro256ss { 91586 });
+        require_statistically_plausible(prng::Pcg32 { 91586 });
+        require_statistically_plausible(prng::Wyrand { 91586 });
+        require_statistically_plausible(prng::Xoshiro256ssx4 { prng::Xoshiro256ss { 91586 } });
+    }
 }
 
 /*
@@ -228,4 +662,55 @@ TEST_CASE("std::ratio") {
 
     REQUIRE(result::num == 20);
     REQUIRE(result::den == 3);
+}
+
+/*
+    Micro-benchmarks for the utilities above, hidden by [!benchmark]. Machine-readable results:
+        ./ccc-12 "[!benchmark]" -r xml -o ccc-12-benchmarks.xml
+*/
+TEST_CASE("Utility benchmarks", "[!benchmark]") {
+    std::mt19937_64 mt_engine{ 91586 };
+    std::minstd_rand lcg_engine{ 91586 };
+    std::random_device rd_engine{};
+    std::uniform_int_distribution<int> die{ 1, 6 };
+    BENCHMARK("mt19937_64()") { return mt_engine(); };
+    BENCHMARK("minstd_rand()") { return lcg_engine(); };
+    BENCHMARK("random_device()") { return rd_engine(); };
+    BENCHMARK("uniform_int_distribution(mt19937_64)") { return die(mt_engine); };
+    prng::Xoshiro256ss xoshiro { 91586 };
+    prng::Pcg32 pcg { 91586 };
+    prng::Wyrand wyrand { 91586 };
+    BENCHMARK("Xoshiro256ss()") { return xoshiro(); };
+    BENCHMARK("Pcg32()") { return pcg(); };
+    BENCHMARK("Wyrand()") { return wyrand(); };
+    BENCHMARK("uniform_int_distribution(Xoshiro256ss)") { return die(xoshiro); };
+    BENCHMARK("construct mt19937_64") { return std::mt19937_64{ 91586 }; };
+    BENCHMARK("construct Xoshiro256ss") { return prng::Xoshiro256ss{ 91586 }; };
+    BENCHMARK("steady_clock::now()") { return std::chrono::steady_clock::now(); };
+    BENCHMARK("system_clock::now()") { return std::chrono::system_clock::now(); };
+
+    const boost::gregorian::date d{ 1986, 9, 15 };
+    BENCHMARK("gregorian::date + days(200)") { return d + boost::gregorian::date_duration{ 200 }; };
+    BENCHMARK("std::optional<int> engaged value_or") {
+        std::optional<int> value{ static_cast<int>(mt_engine() & 1) ? std::optional<int>{ 42 } : std::nullopt };
+        return value.value_or(0);
+    };
+}
+
+TEST_CASE("Random fill benchmarks", "[!benchmark]") {
+    std::vector<uint64_t> wide(4096);
+    std::vector<uint32_t> narrow(4096);
+    std::mt19937_64 mt_engine{ 91586 };
+    prng::Xoshiro256ss xoshiro{ 91586 };
+    prng::Xoshiro256ssx4 xoshiro4{ prng::Xoshiro256ss{ 91586 } };
+    prng::Pcg32 pcg{ 91586 };
+    prng::Wyrand wyrand{ 91586 };
+    BENCHMARK("4096 x mt19937_64()") {
+        for (auto& value : wide) value = mt_engine();
+        return wide.back();
+    };
+    BENCHMARK("Xoshiro256ss::fill(4096)") { xoshiro.fill(wide); return wide.back(); };
+    BENCHMARK("Xoshiro256ssx4::fill(4096)") { xoshiro4.fill(wide); return wide.back(); };
+    BENCHMARK("Wyrand::fill(4096)") { wyrand.fill(wide); return wide.back(); };
+    BENCHMARK("Pcg32::fill(4096 x 32 bits)") { pcg.fill(narrow); return narrow.back(); };
 }
\ No newline at end of file
@@ -4,12 +4,30 @@
     Sequence Containers: STL containers that provide sequential member access
 */
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
+#include <deque>
 #include <array>
 #include <vector>
 #include <stack>
 #include <queue>
 #include <map>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstring>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 /*
     Arrays: RAII wrapper around statically-sized arrays.
@@ -199,8 +217,184 @@ TEST_CASE("std::queue supports push/pop/front/back") {
         - comparator function (optional: defaults to std::less)
     Priority Queues have the same interface as stacks, but pops highest priority instead of FILO-based
 */
-TEST_CASE("std::priority_queue supports push/pop") {
-    std::priority_queue<double> priqueue;
+/*
+    DaryHeap: d-ary heap (4 children per node by default) in one contiguous array, as a priority_queue with handles.
+        - A shallower tree than a binary heap: log_d(n) levels, and the d children of a node sit next to each other,
+          so picking the best child during a sift-down reads one or two cache lines instead of hopping levels.
+        - push() returns a Handle that stays valid while the entry is queued, no matter how it moves around the array.
+          update() / decrease_key() change a queued entry's priority and erase() removes it, both in O(log n),
+          instead of pushing duplicates and skipping stale entries on pop.
+        - push_bulk() appends everything and heapifies once bottom-up (Floyd): O(n) instead of O(n log n).
+    Same ordering convention as std::priority_queue: top() is the largest element under Compare, so a min-heap of
+    timers is DaryHeap<Deadline, 4, std::greater<Deadline>>, where decrease_key moves a timer earlier.
+*/
+template <typename T, size_t D = 4, typename Compare = std::less<T>>
+class DaryHeap {
+    static_assert(D >= 2, "a heap node needs at least two children");
+public:
+    using Handle = size_t;
+
+    bool empty() const { return values.empty(); }
+    size_t size() const { return values.size(); }
+    const T& top() const { return values.front(); }
+    const T& value(Handle handle) const { return values[positions[handle]]; }
+    void reserve(size_t n) { values.reserve(n); handles.reserve(n); positions.reserve(n); }
+
+    Handle push(const T& value) {
+        const auto handle = new_handle(values.size());
+        values.push_back(value);
+        handles.push_back(handle);
+        sift_up(values.size() - 1);
+        return handle;
+    }
+
+    // Appends the whole range and restores the heap once (Floyd); handles are written to handles_out if given
+    template <typename It>
+    void push_bulk(It first, It last, Handle* handles_out = nullptr) {
+        if constexpr (std::random_access_iterator<It>) {
+            reserve(size() + static_cast<size_t>(last - first));
+        }
+        for (; first != last; ++first) {
+            const auto handle = new_handle(values.size());
+            values.push_back(*first);
+            handles.push_back(handle);
+            if (handles_out) {
+                *handles_out++ = handle;
+            }
+        }
+        if (values.size() < 2) {
+            return;
+        }
+        for (auto i = parent(values.size() - 1) + 1; i-- > 0; ) {
+            sift_down(i);
+        }
+    }
+
+    void pop() {
+        free_handles.push_back(handles.front());
+        // Bottom-up: walk the hole from the root down to a leaf along the best children without comparing against
+        // the moved element (that comparison is an unpredictable branch on every level), then drop the last
+        // element into the hole and sift it up - it came from the bottom, so it rarely climbs more than a level.
+        const auto n = values.size() - 1;
+        size_t hole{};
+        for (auto first = first_child(hole); first < n; first = first_child(hole)) {
+            const auto best = best_child(first, n);
+            move_entry(best, hole);
+            hole = best;
+        }
+        if (hole < n) {
+            move_entry(n, hole);
+            sift_up(hole);
+        }
+        values.pop_back();
+        handles.pop_back();
+    }
+
+    void erase(Handle handle) {
+        const auto i = positions[handle];
+        const auto last = values.size() - 1;
+        free_handles.push_back(handle);
+        if (i != last) {
+            move_entry(last, i);
+        }
+        values.pop_back();
+        handles.pop_back();
+        if (i < values.size()) {
+            restore(i);
+        }
+    }
+
+    // New priority for a queued entry, in either direction
+    void update(Handle handle, const T& value) {
+        const auto i = positions[handle];
+        values[i] = value;
+        restore(i);
+    }
+    void decrease_key(Handle handle, const T& value) { update(handle, value); }
+
+private:
+    static size_t parent(size_t i) { return (i - 1) / D; }
+    static size_t first_child(size_t i) { return D * i + 1; }
+
+    Handle new_handle(size_t position) {
+        if (free_handles.empty()) {
+            positions.push_back(position);
+            return positions.size() - 1;
+        }
+        const auto handle = free_handles.back();
+        free_handles.pop_back();
+        positions[handle] = position;
+        return handle;
+    }
+
+    void move_entry(size_t from, size_t to) {
+        values[to] = std::move(values[from]);
+        handles[to] = handles[from];
+        positions[handles[to]] = to;
+    }
+
+    void place(size_t i, T&& value, Handle handle) {
+        values[i] = std::move(value);
+        handles[i] = handle;
+        positions[handle] = i;
+    }
+
+    // Best of the children first..min(first + D, n), picked with selects rather than branches
+    size_t best_child(size_t first, size_t n) const {
+        const auto end = std::min(first + D, n);
+        auto best = first;
+        for (auto child = first + 1; child < end; child++) {
+            best = compare(values[best], values[child]) ? child : best;
+        }
+        return best;
+    }
+
+    void restore(size_t i) {
+        if (i > 0 && compare(values[parent(i)], values[i])) {
+            sift_up(i);
+        } else {
+            sift_down(i);
+        }
+    }
+
+    // Both sifts move a hole instead of swapping, so every step is one move instead of three
+    void sift_up(size_t i) {
+        auto value = std::move(values[i]);
+        const auto handle = handles[i];
+        while (i > 0 && compare(values[parent(i)], value)) {
+            move_entry(parent(i), i);
+            i = parent(i);
+        }
+        place(i, std::move(value), handle);
+    }
+
+    void sift_down(size_t i) {
+        auto value = std::move(values[i]);
+        const auto handle = handles[i];
+        const auto n = values.size();
+        for (auto first = first_child(i); first < n; first = first_child(i)) {
+            const auto best = best_child(first, n);
+            if (!compare(value, values[best])) {
+                break;
+            }
+            move_entry(best, i);
+            i = best;
+        }
+        place(i, std::move(value), handle);
+    }
+
+    // Values live apart from their handles so the comparisons scan a dense array; handles and positions
+    // are only written when an entry moves.
+    std::vector<T> values;
+    std::vector<Handle> handles;     // index in values -> handle
+    std::vector<size_t> positions;   // handle -> index in values
+    std::vector<Handle> free_handles;
+    [[no_unique_address]] Compare compare;
+};
+
+TEMPLATE_TEST_CASE("std::priority_queue supports push/pop", "[heap]",
+                   std::priority_queue<double>, (DaryHeap<double>), (DaryHeap<double, 2>), (DaryHeap<double, 3>)) {
+    TestType priqueue;
     priqueue.push(1.0);
     priqueue.push(2.0);
     priqueue.push(1.5);
@@ -217,6 +411,75 @@ TEST_CASE("std::priority_queue supports push/pop") {
     REQUIRE(priqueue.empty());
 }
 
+TEST_CASE("DaryHeap") {
+    SECTION("handles follow their entries through decrease_key and erase") {
+        DaryHeap<int, 4, std::greater<int>> timers;  // min-heap: earliest deadline on top
+        const auto a = timers.push(50);
+        const auto b = timers.push(30);
+        const auto c = timers.push(40);
+        REQUIRE(timers.top() == 30);
+
+        timers.decrease_key(a, 10);
+        REQUIRE(timers.top() == 10);
+        REQUIRE(timers.value(c) == 40);
+
+        timers.erase(a);
+        REQUIRE(timers.top() == 30);
+        timers.update(b, 45);
+        REQUIRE(timers.top() == 40);
+        REQUIRE(timers.value(b) == 45);
+        REQUIRE(timers.size() == 2);
+    }
+
+    SECTION("push_bulk heapifies in one pass and pops in order") {
+        std::mt19937 rng{ 7 };
+        std::vector<int> values(10'000);
+        for (auto& value : values) {
+            value = static_cast<int>(rng() % 1000);
+        }
+        DaryHeap<int> heap;
+        std::vector<DaryHeap<int>::Handle> handles(values.size());
+        heap.push_bulk(values.begin(), values.end(), handles.data());
+        for (size_t i{}; i < values.size(); i++) {
+            REQUIRE(heap.value(handles[i]) == values[i]);
+        }
+        std::sort(values.begin(), values.end(), std::greater<int>{});
+        for (auto expected : values) {
+            REQUIRE(heap.top() == expected);
+            heap.pop();
+        }
+        REQUIRE(heap.empty());
+    }
+
+    SECTION("random updates and erases agree with a sorted reference") {
+        std::mt19937 rng{ 11 };
+        DaryHeap<int, 3> heap;
+        std::map<DaryHeap<int, 3>::Handle, int> live;
+        for (int step{}; step < 20'000; step++) {
+            const auto action = rng() % 4;
+            if (action < 2 || live.empty()) {
+                const auto value = static_cast<int>(rng() % 100'000);
+                live[heap.push(value)] = value;
+            } else {
+                auto it = std::next(live.begin(), static_cast<long>(rng() % live.size()));
+                if (action == 2) {
+                    it->second = static_cast<int>(rng() % 100'000);
+                    heap.update(it->first, it->second);
+                } else {
+                    heap.erase(it->first);
+                    live.erase(it);
+                }
+            }
+            if (!live.empty()) {
+                const auto best = std::max_element(live.begin(), live.end(),
+                                                   [](auto& x, auto& y) { return x.second < y.second; });
+                REQUIRE(heap.top() == best->second);
+            }
+        }
+        REQUIRE(heap.size() == live.size());
+    }
+}
+
 /*
     Map: STL container that maps keys to values.
     Template parameters are:
@@ -225,18 +488,174 @@ TEST_CASE("std::priority_queue supports push/pop") {
         - comparator (optional: defaults to std::less)
         - allocator (optional: defaults to std::allocator)
 */
+/*
+    FlatMap: sorted-vector alternative to std::map for lookup-heavy, mostly read-only data.
+        - std::map allocates one node per element and every lookup chases log2(n) pointers through them.
+          FlatMap keeps the keys in one sorted array and the values in a second one: a lookup walks only the compact
+          key array, and the values are touched once, at the end.
+        - find / at / operator[] use a branchless lower bound. The loop always runs ceil(log2(n)) times, the
+          comparison turns into a conditional move, and nothing is mispredicted.
+        - Bulk loading (the range / initializer_list constructors and assign) sorts once and drops duplicate keys,
+          keeping the first one like std::map's insert does.
+        - Inserting or erasing one key shifts the arrays: O(n), fine for occasional writes, not for write-heavy use.
+    Iterators yield pair<const K&, V&> (a proxy, there is no stored pair), so `it->second` and structured bindings work.
+*/
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using size_type = size_t;
+
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using Map = std::conditional_t<Const, const FlatMap, FlatMap>;
+        using reference = std::pair<const K&, std::conditional_t<Const, const V&, V&>>;
+        struct pointer {
+            reference ref;
+            reference* operator->() { return &ref; }
+        };
+
+        basic_iterator(Map* map, size_t index) : map{ map }, index{ index } { }
+        reference operator*() const { return { map->keys[index], map->values[index] }; }
+        pointer operator->() const { return { **this }; }
+        basic_iterator& operator++() { index++; return *this; }
+        bool operator==(const basic_iterator& other) const { return index == other.index; }
+        bool operator!=(const basic_iterator& other) const { return index != other.index; }
+        size_t position() const { return index; }
+
+    private:
+        Map* map;
+        size_t index;
+    };
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    FlatMap() = default;
+    FlatMap(std::initializer_list<std::pair<const K, V>> pairs) { assign(pairs.begin(), pairs.end()); }
+    template <typename It>
+    FlatMap(It first, It last) { assign(first, last); }
+
+    // Bulk load: one sort of an index permutation, then both arrays are filled in key order
+    template <typename It>
+    void assign(It first, It last) {
+        std::vector<std::pair<K, V>> pairs(first, last);
+        std::vector<size_t> order(pairs.size());
+        std::iota(order.begin(), order.end(), size_t{});
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return compare(pairs[a].first, pairs[b].first); });
+        keys.clear();
+        values.clear();
+        keys.reserve(pairs.size());
+        values.reserve(pairs.size());
+        for (auto i : order) {
+            if (!keys.empty() && !compare(keys.back(), pairs[i].first)) {
+                continue;  // duplicate: the first one in input order wins
+            }
+            keys.push_back(std::move(pairs[i].first));
+            values.push_back(std::move(pairs[i].second));
+        }
+    }
+
+    bool empty() const { return keys.empty(); }
+    size_t size() const { return keys.size(); }
+    void clear() { keys.clear(); values.clear(); }
+    void reserve(size_t n) { keys.reserve(n); values.reserve(n); }
+
+    iterator begin() { return { this, 0 }; }
+    iterator end() { return { this, size() }; }
+    const_iterator begin() const { return { this, 0 }; }
+    const_iterator end() const { return { this, size() }; }
+
+    iterator find(const K& key) {
+        const auto i = lower_bound(key);
+        return { this, found(i, key) ? i : size() };
+    }
+    const_iterator find(const K& key) const {
+        const auto i = lower_bound(key);
+        return { this, found(i, key) ? i : size() };
+    }
+    bool contains(const K& key) const { return found(lower_bound(key), key); }
+    size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    V& at(const K& key) {
+        const auto i = lower_bound(key);
+        if (!found(i, key)) {
+            throw std::out_of_range{ "FlatMap::at" };
+        }
+        return values[i];
+    }
+    const V& at(const K& key) const { return const_cast<FlatMap*>(this)->at(key); }
+
+    V& operator[](const K& key) {
+        const auto i = lower_bound(key);
+        if (!found(i, key)) {
+            insert_at(i, key, V{});
+        }
+        return values[i];
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<const K, V>& pair) {
+        const auto i = lower_bound(pair.first);
+        if (found(i, pair.first)) {
+            return { iterator{ this, i }, false };
+        }
+        insert_at(i, pair.first, pair.second);
+        return { iterator{ this, i }, true };
+    }
+
+    size_t erase(const K& key) {
+        const auto i = lower_bound(key);
+        if (!found(i, key)) {
+            return 0;
+        }
+        keys.erase(keys.begin() + i);
+        values.erase(values.begin() + i);
+        return 1;
+    }
+
+private:
+    // Branchless lower bound: halve the range every step, the comparison only scales the step (compiles to no branch)
+    size_t lower_bound(const K& key) const {
+        size_t n = keys.size();
+        if (n == 0) {
+            return 0;
+        }
+        const K* base = keys.data();
+        while (n > 1) {
+            const auto half = n / 2;
+            base += compare(base[half - 1], key) * half;
+            n -= half;
+        }
+        return static_cast<size_t>(base - keys.data()) + compare(*base, key);
+    }
+
+    bool found(size_t i, const K& key) const { return i < keys.size() && !compare(key, keys[i]); }
+
+    void insert_at(size_t i, const K& key, const V& value) {
+        keys.insert(keys.begin() + i, key);
+        values.insert(values.begin() + i, value);
+    }
+
+    std::vector<K> keys;
+    std::vector<V> values;
+    [[no_unique_address]] Compare compare;
+};
+
 auto color_of_magic = "Color of Magic";
 auto the_light_fantastic = "The Light Fantastic";
 auto equal_rites = "Equal Rites";
 auto mort = "Mort";
-TEST_CASE("std::map") {
+// The same sections run against std::map and FlatMap
+TEMPLATE_TEST_CASE("std::map", "[map]", (std::map<const char*, int>), (FlatMap<const char*, int>)) {
     SECTION("supports") {
         SECTION("Default construction") {
-            std::map<const char*, int> emp;
+            TestType emp;
             REQUIRE(emp.empty());
         }
         SECTION("braced initialization") {
-            std::map<const char*, int> pub_year {
+            TestType pub_year {
                 { color_of_magic, 1983 },
                 { the_light_fantastic, 1986 },
                 { equal_rites, 1987 },
@@ -245,7 +664,7 @@ TEST_CASE("std::map") {
             REQUIRE(pub_year.size() == 4);
         }
         SECTION("is an associative array with") {
-            std::map<const char*, int> pub_year {
+            TestType pub_year {
                 { color_of_magic, 1983 },
                 { the_light_fantastic, 1986 }
             };
@@ -267,4 +686,330 @@ TEST_CASE("std::map") {
             }
         }
     }
+}
+
+TEST_CASE("FlatMap") {
+    SECTION("bulk loads unsorted input with one sort, keeping the first duplicate") {
+        std::vector<std::pair<int, int>> pairs { { 5, 50 }, { 1, 10 }, { 3, 30 }, { 1, 11 }, { 4, 40 } };
+        FlatMap<int, int> map(pairs.begin(), pairs.end());
+        REQUIRE(map.size() == 4);
+        REQUIRE(map.at(1) == 10);
+        std::vector<int> keys;
+        for (auto [key, value] : map) {
+            keys.push_back(key);
+            REQUIRE(value == key * 10);
+        }
+        REQUIRE(keys == std::vector<int>{ 1, 3, 4, 5 });
+    }
+
+    SECTION("find, contains and insert keep keys sorted") {
+        FlatMap<int, int> map;
+        for (int key : { 8, 2, 6, 4, 0 }) {
+            REQUIRE(map.insert({ key, key * key }).second);
+        }
+        REQUIRE_FALSE(map.insert({ 6, 0 }).second);
+        REQUIRE(map.find(6)->second == 36);
+        REQUIRE(map.find(5) == map.end());
+        REQUIRE(map.find(9) == map.end());
+        REQUIRE(map.find(-1) == map.end());
+        REQUIRE(map.contains(0));
+        REQUIRE(map.count(3) == 0);
+        REQUIRE(map.erase(2) == 1);
+        REQUIRE(map.erase(2) == 0);
+        REQUIRE(map.begin()->first == 0);
+        REQUIRE((++map.begin())->first == 4);
+    }
+
+    SECTION("lower bound agrees with std::map on every key and every gap") {
+        std::map<int, int> tree;
+        FlatMap<int, int> flat;
+        for (int i{}; i < 1000; i++) {
+            tree[i * 3] = i;
+            flat[i * 3] = i;
+        }
+        for (int key { -2 }; key < 3003; key++) {
+            const auto in_tree = tree.find(key);
+            const auto in_flat = flat.find(key);
+            REQUIRE((in_tree == tree.end()) == (in_flat == flat.end()));
+            if (in_tree != tree.end()) {
+                REQUIRE(in_tree->second == in_flat->second);
+            }
+        }
+    }
+}
+
+/*
+    Random successful lookups against std::map and FlatMap at three working-set sizes. uint32_t keys and values:
+    FlatMap needs 8 bytes per element, std::map about 48 (node + allocator overhead).
+        - L1:   2'048 elements (16 KiB flat)
+        - L2:  65'536 elements (512 KiB flat, ~3 MiB of tree nodes)
+        - DRAM: 8'388'608 elements (64 MiB flat, ~400 MiB of tree nodes)
+    Hidden by the leading dot; run with: ./ccc-13 "[.benchmark]"
+*/
+TEST_CASE("FlatMap vs std::map lookups", "[.benchmark]") {
+    const size_t lookups { 4'000'000 };
+    for (size_t elements : { size_t{ 2'048 }, size_t{ 65'536 }, size_t{ 8'388'608 } }) {
+        std::mt19937 rng{ 42 };
+        std::vector<std::pair<uint32_t, uint32_t>> pairs(elements);
+        for (auto& [key, value] : pairs) {
+            key = static_cast<uint32_t>(rng());
+            value = key ^ 0x5555'5555;
+        }
+        std::vector<uint32_t> probes(lookups);
+        for (auto& probe : probes) {
+            probe = pairs[rng() % elements].first;
+        }
+
+        auto time_lookups = [&](auto& map) {
+            uint64_t checksum{};
+            const auto start = std::chrono::steady_clock::now();
+            for (auto probe : probes) {
+                checksum += map.find(probe)->second;
+            }
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            REQUIRE(checksum != 0);
+            return elapsed.count() / lookups;
+        };
+
+        double tree_ns{}, flat_ns{};
+        {
+            std::map<uint32_t, uint32_t> tree(pairs.begin(), pairs.end());
+            tree_ns = time_lookups(tree);
+        }
+        {
+            FlatMap<uint32_t, uint32_t> flat(pairs.begin(), pairs.end());
+            flat_ns = time_lookups(flat);
+        }
+        printf("%9zu elements: std::map %7.1f ns/lookup, FlatMap %7.1f ns/lookup (%.1fx)\n",
+               elements, tree_ns, flat_ns, tree_ns / flat_ns);
+    }
+}
+
+// Hardware cache-miss counter for the calling thread (Linux perf events). Reports -1 where unavailable.
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+    void start() {
+#if defined(__linux__)
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    long long stop() {
+        long long misses { -1 };
+#if defined(__linux__)
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &misses, sizeof(misses)) != sizeof(misses)) {
+                misses = -1;
+            }
+        }
+#endif
+        return misses;
+    }
+private:
+    int fd { -1 };
+};
+
+/*
+    Push/pop throughput with 1M random doubles: push everything one by one, then pop everything.
+    Cache misses come from the hardware counter where the kernel allows it (perf_event_paranoid, VMs), else "n/a".
+    Hidden by the leading dot; run with: ./ccc-13 "[.benchmark]"
+*/
+TEST_CASE("DaryHeap vs std::priority_queue push/pop", "[.benchmark]") {
+    const size_t entries { 1'000'000 };
+    std::mt19937_64 rng{ 3 };
+    std::uniform_real_distribution<double> uniform{ 0.0, 1.0 };
+    std::vector<double> values(entries);
+    for (auto& value : values) {
+        value = uniform(rng);
+    }
+
+    auto run = [&](const char* name, auto heap) {
+        CacheMissCounter misses;
+        double checksum{};
+        misses.start();
+        const auto start = std::chrono::steady_clock::now();
+        for (auto value : values) {
+            heap.push(value);
+        }
+        const auto pushed = std::chrono::steady_clock::now();
+        while (!heap.empty()) {
+            checksum += heap.top();
+            heap.pop();
+        }
+        const auto popped = std::chrono::steady_clock::now();
+        const auto miss_count = misses.stop();
+        REQUIRE(checksum > 0.0);
+
+        const std::chrono::duration<double, std::nano> push_ns = pushed - start, pop_ns = popped - pushed;
+        char miss_text[32] = "n/a";
+        if (miss_count >= 0) {
+            snprintf(miss_text, sizeof(miss_text), "%.2f", static_cast<double>(miss_count) / entries);
+        }
+        printf("%-28s push %6.1f ns  pop %6.1f ns  cache misses/entry %s\n",
+               name, push_ns.count() / entries, pop_ns.count() / entries, miss_text);
+    };
+
+    run("std::priority_queue<double>", std::priority_queue<double>{});
+    run("DaryHeap<double, 2>", DaryHeap<double, 2>{});
+    run("DaryHeap<double, 4>", DaryHeap<double, 4>{});
+    run("DaryHeap<double, 8>", DaryHeap<double, 8>{});
+
+    const auto start = std::chrono::steady_clock::now();
+    DaryHeap<double> bulk;
+    bulk.push_bulk(values.begin(), values.end());
+    const std::chrono::duration<double, std::nano> bulk_ns = std::chrono::steady_clock::now() - start;
+    printf("DaryHeap<double, 4> push_bulk  %6.1f ns/entry\n", bulk_ns.count() / entries);
+
+    /*
+        The timer case: 1M queued deadlines, 1M of them moved earlier, then drain. std::priority_queue has to push
+        a duplicate per reschedule and skip stale entries when they surface; DaryHeap updates in place.
+    */
+    std::vector<uint32_t> reschedules(entries);
+    for (auto& timer : reschedules) {
+        timer = static_cast<uint32_t>(rng() % entries);
+    }
+    auto timed = [&](const char* name, auto&& workload) {
+        const auto begin = std::chrono::steady_clock::now();
+        const auto fired = workload();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+        REQUIRE(fired == entries);
+        printf("%-28s %6.1f ns per timer (schedule + reschedule + fire)\n", name, elapsed.count() / entries);
+    };
+    timed("std::priority_queue + stale", [&] {
+        std::vector<double> deadline(values);
+        std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>, std::greater<>> timers;
+        for (uint32_t i{}; i < entries; i++) {
+            timers.push({ deadline[i], i });
+        }
+        for (auto timer : reschedules) {
+            deadline[timer] *= 0.5;
+            timers.push({ deadline[timer], timer });
+        }
+        std::vector<bool> done(entries);
+        size_t fired{};
+        while (!timers.empty()) {
+            const auto [when, timer] = timers.top();
+            timers.pop();
+            if (done[timer] || when != deadline[timer]) {
+                continue;
+            }
+            done[timer] = true;
+            fired++;
+        }
+        return fired;
+    });
+    timed("DaryHeap + decrease_key", [&] {
+        DaryHeap<double, 4, std::greater<double>> timers;
+        std::vector<decltype(timers)::Handle> handles(entries);
+        timers.push_bulk(values.begin(), values.end(), handles.data());
+        for (auto timer : reschedules) {
+            timers.decrease_key(handles[timer], timers.value(handles[timer]) * 0.5);
+        }
+        size_t fired{};
+        for (; !timers.empty(); timers.pop()) {
+            fired++;
+        }
+        return fired;
+    });
+}
+
+/*
+    Micro-benchmark suite. Catch2's BENCHMARK runs each block until the clock resolution stops mattering, takes
+    100 samples and bootstraps a mean and standard deviation. The [!benchmark] tag hides it from normal runs; for
+    numbers that can be diffed between commits use the XML reporter, which records every BenchmarkResults element
+    with its mean, confidence bounds and standard deviation in nanoseconds:
+        ./ccc-13 "[!benchmark]" -r xml -o ccc-13-benchmarks.xml
+*/
+TEST_CASE("Container benchmarks", "[!benchmark]") {
+    std::vector<int> keys(4096);
+    std::mt19937 engine{ 2024 };
+    for (auto& key : keys) key = static_cast<int>(engine() % 1'000'000);
+    std::map<int, int> tree;
+    FlatMap<int, int> flat;
+    for (auto key : keys) {
+        tree[key] = key;
+        flat[key] = key;
+    }
+
+    BENCHMARK("std::vector push_back x4096") {
+        std::vector<int> values;
+        for (auto key : keys) values.push_back(key);
+        return values.size();
+    };
+    BENCHMARK("std::vector reserve + push_back x4096") {
+        std::vector<int> values;
+        values.reserve(keys.size());
+        for (auto key : keys) values.push_back(key);
+        return values.size();
+    };
+    BENCHMARK("std::array<int, 4096> copy + sort") {
+        std::array<int, 4096> values;
+        std::copy(keys.begin(), keys.end(), values.begin());
+        std::sort(values.begin(), values.end());
+        return values.front();
+    };
+    BENCHMARK("std::deque push_back + pop_front x4096") {
+        std::deque<int> queue;
+        long long sum{};
+        for (auto key : keys) queue.push_back(key);
+        while (!queue.empty()) {
+            sum += queue.front();
+            queue.pop_front();
+        }
+        return sum;
+    };
+    BENCHMARK("std::map find x4096") {
+        long long sum{};
+        for (auto key : keys) sum += tree.find(key)->second;
+        return sum;
+    };
+    BENCHMARK("FlatMap find x4096") {
+        long long sum{};
+        for (auto key : keys) sum += (*flat.find(key)).second;
+        return sum;
+    };
+    BENCHMARK("std::priority_queue push + pop x4096") {
+        std::priority_queue<int> heap;
+        for (auto key : keys) heap.push(key);
+        long long sum{};
+        while (!heap.empty()) {
+            sum += heap.top();
+            heap.pop();
+        }
+        return sum;
+    };
+    BENCHMARK("DaryHeap push + pop x4096") {
+        DaryHeap<int> heap;
+        heap.reserve(keys.size());
+        for (auto key : keys) heap.push(key);
+        long long sum{};
+        while (!heap.empty()) {
+            sum += heap.top();
+            heap.pop();
+        }
+        return sum;
+    };
 }
\ No newline at end of file
@@ -11,9 +11,26 @@
         - std::u32string -> for char32_t, used for character sets like UTF-32 
 */
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 #include <string>
 #include <regex>
+#include <array>
+#include <vector>
+#include <string_view>
+#include <stdexcept>
+#include <optional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <chrono>
+#include <cstdio>
+#include <charconv>
+#include <limits>
+#include <type_traits>
 
 TEST_CASE("std::string") {
     SECTION("supports constructing") {
@@ -126,6 +143,188 @@ TEST_CASE("std::string") {
     }
 }
 
+// A string literal usable as a template argument, e.g. format<"<{}, {}>">(...) or dfa::match<"a+b">(text)
+template <size_t N>
+struct FixedString {
+    char chars[N]{};
+    constexpr FixedString(const char (&text)[N]) {
+        for (size_t i{}; i < N; i++) chars[i] = text[i];
+    }
+    constexpr std::string_view view() const { return { chars, N - 1 }; }
+};
+
+/*
+    conv: the conversions below without their costs, built on <charconv>.
+        - std::stoi and friends throw on bad input, honour the C locale and need a std::string; std::to_string
+          allocates a string per call (and prints doubles with %f, so 0.1 becomes "0.100000").
+        - parse<T>(text) returns std::optional<T>; parse_to(text, value) returns the std::errc instead. Like stoi they
+          skip leading whitespace and a '+', accept 0x in base 16, stop at the first character that doesn't fit and
+          report how many characters they used. Nothing throws and nothing allocates.
+        - to_string(value) formats into a StackString on the stack. Floating point uses to_chars' shortest form:
+          the fewest digits that parse back to exactly the same value.
+        - format<"<{}, {}, {}>">(...) splits the format string at compile time (a wrong argument count is a
+          compile error) and format_to writes into a caller's buffer, reporting errc::value_too_large if it is full.
+*/
+namespace conv {
+
+// A fixed-capacity, null-terminated string in place
+template <size_t Capacity>
+class StackString {
+public:
+    constexpr std::string_view view() const { return { buffer.data(), length }; }
+    constexpr operator std::string_view() const { return view(); }
+    constexpr const char* c_str() const { return buffer.data(); }
+    constexpr size_t size() const { return length; }
+
+    char* data() { return buffer.data(); }
+    static constexpr size_t capacity() { return Capacity; }
+    void resize(size_t size) {
+        length = size;
+        buffer[size] = '\0';
+    }
+
+private:
+    std::array<char, Capacity + 1> buffer{};
+    size_t length{};
+};
+
+template <typename T>
+std::errc parse_to(std::string_view text, T& value, size_t* consumed = nullptr, int base = 10) {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "parse_to needs a number type");
+    size_t start{};
+    while (start < text.size() && (text[start] == ' ' || (text[start] >= '\t' && text[start] <= '\r'))) start++;
+    if (start < text.size() && text[start] == '+') {
+        start++;
+        if (start < text.size() && text[start] == '-') return std::errc::invalid_argument;
+    }
+    if constexpr (std::is_integral_v<T>) {
+        if (base == 16 && start + 2 < text.size() && text[start] == '0' && (text[start + 1] | 0x20) == 'x') {
+            start += 2;
+        }
+    }
+    const auto first = text.data() + start, last = text.data() + text.size();
+    std::from_chars_result result;
+    if constexpr (std::is_floating_point_v<T>) {
+        result = std::from_chars(first, last, value);
+    } else {
+        result = std::from_chars(first, last, value, base);
+    }
+    if (result.ec != std::errc{}) {
+        return result.ec;
+    }
+    if (consumed) {
+        *consumed = static_cast<size_t>(result.ptr - text.data());
+    }
+    return {};
+}
+
+template <typename T>
+std::optional<T> parse(std::string_view text, size_t* consumed = nullptr, int base = 10) {
+    T value{};
+    if (parse_to(text, value, consumed, base) != std::errc{}) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Longest output of to_chars for T: sign and digits for integers, "-1.7976931348623157e+308" for double
+template <typename T>
+constexpr size_t max_chars() {
+    if constexpr (std::is_floating_point_v<T>) {
+        return 4 + std::numeric_limits<T>::max_digits10 + 2 + 5;
+    } else {
+        return std::numeric_limits<T>::digits10 + 2;
+    }
+}
+
+template <typename T>
+StackString<max_chars<T>()> to_string(T value) {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "to_string needs a number type");
+    StackString<max_chars<T>()> result;
+    const auto [end, error] = std::to_chars(result.data(), result.data() + result.capacity(), value);
+    result.resize(error == std::errc{} ? static_cast<size_t>(end - result.data()) : 0);
+    return result;
+}
+
+// The format string's literal text with {{ and }} unescaped, split around the {} placeholders
+template <size_t N>
+struct ParsedFormat {
+    std::array<char, N> text{};
+    std::array<size_t, N + 1> ends{};  // ends[i] is where segment i stops; segment i + 1 starts there
+    size_t placeholders{};
+};
+
+template <FixedString Format>
+constexpr auto parse_format() {
+    constexpr auto format = Format.view();
+    ParsedFormat<format.size() + 1> parsed;
+    size_t length{};
+    for (size_t i{}; i < format.size(); i++) {
+        if (format[i] == '{' && i + 1 < format.size() && format[i + 1] == '}') {
+            parsed.ends[parsed.placeholders++] = length;
+            i++;
+        } else if ((format[i] == '{' || format[i] == '}') && i + 1 < format.size() && format[i + 1] == format[i]) {
+            parsed.text[length++] = format[i++];
+        } else if (format[i] == '{' || format[i] == '}') {
+            throw std::invalid_argument{ "format: unmatched brace (only {} placeholders are supported)" };
+        } else {
+            parsed.text[length++] = format[i];
+        }
+    }
+    parsed.ends[parsed.placeholders] = length;
+    return parsed;
+}
+
+template <typename T>
+bool write_value(char*& out, char* last, const T& value) {
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>) {
+        const auto [end, error] = std::to_chars(out, last, value);
+        if (error != std::errc{}) return false;
+        out = end;
+        return true;
+    } else if constexpr (std::is_same_v<T, char>) {
+        if (out == last) return false;
+        *out++ = value;
+        return true;
+    } else {
+        const std::string_view text{ value };
+        if (static_cast<size_t>(last - out) < text.size()) return false;
+        out = std::copy(text.begin(), text.end(), out);
+        return true;
+    }
+}
+
+template <FixedString Format, typename... Args>
+std::to_chars_result format_to(char* first, char* last, const Args&... args) {
+    static constexpr auto parsed = parse_format<Format>();
+    static_assert(parsed.placeholders == sizeof...(Args), "format: number of {} and arguments differ");
+    auto out = first;
+    size_t segment{}, start{};
+    auto write_segment = [&] {
+        const auto end = parsed.ends[segment++];
+        const auto length = end - start;
+        if (static_cast<size_t>(last - out) < length) return false;
+        out = std::copy(parsed.text.data() + start, parsed.text.data() + end, out);
+        start = end;
+        return true;
+    };
+    const bool fits = write_segment() && ((write_value(out, last, args) && write_segment()) && ...);
+    if (!fits) {
+        return { last, std::errc::value_too_large };
+    }
+    return { out, std::errc{} };
+}
+
+template <FixedString Format, size_t Capacity = 128, typename... Args>
+StackString<Capacity> format(const Args&... args) {
+    StackString<Capacity> result;
+    const auto [end, error] = format_to<Format>(result.data(), result.data() + Capacity, args...);
+    result.resize(error == std::errc{} ? static_cast<size_t>(end - result.data()) : 0);
+    return result;
+}
+
+} // namespace conv
+
 TEST_CASE("STL String Conversion") {
     using namespace std::literals::string_literals;
     SECTION("to_string") {
@@ -157,6 +356,100 @@ TEST_CASE("STL String Conversion") {
     }
 }
 
+// The sections above through conv: same inputs, errors as values instead of exceptions
+TEST_CASE("conv") {
+    SECTION("to_string") {
+        REQUIRE(conv::to_string(542345).view() == "542345");
+        REQUIRE(conv::to_string(-2147483647 - 1).view() == "-2147483648");
+    }
+    SECTION("to_string with doubles is shortest round-trip") {
+        REQUIRE(conv::to_string(12360359.584086).view() == "12360359.584086");
+        REQUIRE(conv::to_string(0.1).view() == "0.1");
+        for (auto value : { 2.7182818, 1.0 / 3.0, 1e-300, -1.7976931348623157e308, 5e-324 }) {
+            REQUIRE(conv::parse<double>(conv::to_string(value)) == value);
+        }
+    }
+    SECTION("parse") {
+        REQUIRE(conv::parse<int>("8675309") == 8675309);
+        REQUIRE(conv::parse<int>("  +42") == 42);
+    }
+    SECTION("parse reports out of range") {
+        REQUIRE_FALSE(conv::parse<int>("1099511627776"));
+        int value{};
+        REQUIRE(conv::parse_to("1099511627776", value) == std::errc::result_out_of_range);
+        REQUIRE(conv::parse<long long>("1099511627776") == 1099511627776);
+    }
+    SECTION("parse reports invalid input") {
+        int value{};
+        REQUIRE(conv::parse_to("six", value) == std::errc::invalid_argument);
+        REQUIRE(conv::parse_to("+-1", value) == std::errc::invalid_argument);
+        REQUIRE_FALSE(conv::parse<unsigned>("-1"));  // stoul would wrap this around
+    }
+    SECTION("parse with all valid characters") {
+        size_t last_character{};
+        const auto result = conv::parse<unsigned long>("0xD3C34C3D", &last_character, 16);
+        REQUIRE(result == 0xD3C34C3D);
+        REQUIRE(last_character == 10);
+    }
+    SECTION("parse stops at the first invalid character") {
+        size_t last_character{};
+        const auto result = conv::parse<unsigned long>("42six", &last_character);
+        REQUIRE(result == 42);
+        REQUIRE(last_character == 2);
+    }
+    SECTION("parse doubles") {
+        REQUIRE(*conv::parse<double>("2.7182818") == Approx(2.7182818));
+    }
+    SECTION("format") {
+        REQUIRE(conv::format<"<{}, {}, {}>">(300.0f, 0.5f, 1.0f).view() == "<300, 0.5, 1>");
+        REQUIRE(conv::format<"{{{}}} {} {}">(7, "seven", '!').view() == "{7} seven !");
+        char small[8];
+        REQUIRE(conv::format_to<"<{}, {}>">(small, small + sizeof(small), 1234, 5678).ec == std::errc::value_too_large);
+        REQUIRE(conv::format<"<{}, {}>", 8>(1234, 5678).view().empty());
+    }
+}
+
+/*
+    std conversions vs conv over a million numbers.
+    Hidden by the leading dot; run with: ./ccc-15 "[.benchmark]"
+*/
+TEST_CASE("conv vs std conversions", "[.benchmark]") {
+    std::vector<int> integers(1'000'000);
+    std::vector<double> doubles(integers.size());
+    uint32_t seed { 42 };
+    for (size_t i{}; i < integers.size(); i++) {
+        seed = seed * 1664525 + 1013904223;
+        integers[i] = static_cast<int>(seed) >> (seed % 24);
+        doubles[i] = integers[i] / 977.0;
+    }
+    std::vector<std::string> integer_text, double_text;
+    for (size_t i{}; i < integers.size(); i++) {
+        integer_text.push_back(std::to_string(integers[i]));
+        double_text.push_back(std::string{ conv::to_string(doubles[i]).view() });
+    }
+    auto time = [&](const char* name, auto&& per_item) {
+        size_t check{};
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i{}; i < integers.size(); i++) check += per_item(i);
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-36s %7.1f ns/item (check %zu)\n", name, elapsed.count() / integers.size(), check);
+    };
+    time("std::to_string(int)", [&](size_t i) { return std::to_string(integers[i]).size(); });
+    time("conv::to_string(int)", [&](size_t i) { return conv::to_string(integers[i]).size(); });
+    time("std::to_string(double) (%f)", [&](size_t i) { return std::to_string(doubles[i]).size(); });
+    time("conv::to_string(double) (shortest)", [&](size_t i) { return conv::to_string(doubles[i]).size(); });
+    time("std::stoi", [&](size_t i) { return static_cast<size_t>(std::stoi(integer_text[i])); });
+    time("conv::parse<int>", [&](size_t i) { return static_cast<size_t>(*conv::parse<int>(integer_text[i])); });
+    time("std::stod", [&](size_t i) { return static_cast<size_t>(std::stod(double_text[i])); });
+    time("conv::parse<double>", [&](size_t i) { return static_cast<size_t>(*conv::parse<double>(double_text[i])); });
+    time("\"<\" + to_string x3 + \">\"", [&](size_t i) {
+        return ("<" + std::to_string(doubles[i]) + ", " + std::to_string(doubles[i] * 2) + ", " + std::to_string(doubles[i] * 3) + ">").size();
+    });
+    time("conv::format<\"<{}, {}, {}>\">", [&](size_t i) {
+        return conv::format<"<{}, {}, {}>">(doubles[i], doubles[i] * 2, doubles[i] * 3).size();
+    });
+}
+
 /*
     Regex Algorithms: <regex> header provides three algorithms for applying std::basic_regex to a target string
         - matching: attempts to marry a regular expression to the entirity of a string
@@ -200,4 +493,981 @@ TEST_CASE("regex") {
         const auto result = std::regex_replace(sentence, vowels, "_");
         REQUIRE(result == "q_____ng _nd c_____ng _n __t_p__");
     }
+}
+
+/*
+    dfa: a regex-free pattern engine for the handful of fixed patterns we run over millions of log lines.
+    std::regex parses the pattern at runtime and then backtracks through it for every input position. Here a pattern
+    is turned into a deterministic finite automaton once - at compile time for literal patterns - and matching is
+    one table lookup per input byte, with no backtracking and no allocation.
+        - Syntax (ECMAScript subset): literals, ., [...] / [^...] with ranges, \d \w \s \D \W \S, escapes,
+          groups (...) and (?:...), |, * + ? {n} {n,} {n,m}, plus ^ / $ at the start / end of a top-level
+          alternative (as in ECMAScript, ^a|b anchors only the a).
+          No captures, backreferences, lookaround or lazy quantifiers: those need std::regex.
+        - Pipeline: recursive-descent parser -> syntax tree -> Thompson NFA -> subset construction into a DFA over
+          byte classes (bytes the pattern can't tell apart share a column, which keeps the table small).
+        - search() finds the leftmost match and, unlike ECMAScript's first-alternative rule, extends it to the
+          longest one (POSIX style). The two only differ for alternations like a|ab. Instead of a retry at every
+          position it runs two more DFAs: an unanchored one forward to where that match ends, the reversed pattern
+          back from there to where it starts, so each byte is read at most twice. replace() starts a new
+          search after each match, so a pattern whose dead ends outlast its matches (a|a[^z]*z) can reread text.
+        - Prefilter: if every match has to start with the same literal, the DFA knows it - while nothing is in
+          flight, search() jumps ahead with string_view::find (memchr + memcmp). Otherwise a 256-entry table of
+          possible first bytes skips ahead.
+        - match<"pattern">(text) / search / replace build the DFA at compile time (a bad pattern is a compile error).
+          match(text, pattern) with a runtime string goes through a process-wide cache, so each distinct pattern
+          is compiled once.
+*/
+namespace dfa {
+
+struct ByteSet {
+    std::array<uint64_t, 4> bits{};
+    constexpr void add(unsigned char c) { bits[c >> 6] |= uint64_t{ 1 } << (c & 63); }
+    constexpr void add_range(unsigned lo, unsigned hi) {
+        for (auto c = lo; c <= hi; c++) add(static_cast<unsigned char>(c));
+    }
+    constexpr bool has(unsigned char c) const { return (bits[c >> 6] >> (c & 63)) & 1; }
+    constexpr void merge(const ByteSet& other) {
+        for (size_t i{}; i < bits.size(); i++) bits[i] |= other.bits[i];
+    }
+    constexpr void invert() {
+        for (auto& word : bits) word = ~word;
+    }
+};
+
+// One top-level alternative of the pattern, with the anchors around it
+struct Alternative {
+    int root{};
+    bool at_start{}, at_end{};
+};
+
+struct Node {
+    enum Kind { Empty, Set, Concat, Alternate, Repeat } kind;
+    ByteSet set{};
+    int left{ -1 }, right{ -1 };
+    int min{}, max{};  // Repeat; max == -1 is unbounded
+};
+
+class Parser {
+public:
+    constexpr explicit Parser(std::string_view pattern) : pattern{ pattern } { }
+
+    // Only the top level is split by hand: that is the one place ^ and $ may appear
+    constexpr void parse() {
+        while (true) {
+            Alternative alternative;
+            if (!at_end() && peek() == '^') {
+                alternative.at_start = true;
+                pos++;
+            }
+            alternative.root = parse_concatenation();
+            if (at_anchoring_dollar()) {
+                alternative.at_end = true;
+                pos++;
+            }
+            alternatives.push_back(alternative);
+            if (at_end()) return;
+            if (pattern[pos++] != '|') {
+                throw std::invalid_argument{ "dfa: unbalanced ')'" };
+            }
+        }
+    }
+
+    std::vector<Node> nodes;
+    std::vector<Alternative> alternatives;
+
+private:
+    constexpr int add(Node node) {
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size()) - 1;
+    }
+    constexpr bool at_end() const { return pos == pattern.size(); }
+    constexpr char peek() const { return pattern[pos]; }
+    constexpr bool at_anchoring_dollar() const {
+        return depth == 0 && !at_end() && peek() == '$' && (pos + 1 == pattern.size() || pattern[pos + 1] == '|');
+    }
+
+    constexpr int parse_alternation() {
+        auto left = parse_concatenation();
+        while (!at_end() && peek() == '|') {
+            pos++;
+            const auto right = parse_concatenation();
+            left = add(Node{ Node::Alternate, {}, left, right });
+        }
+        return left;
+    }
+
+    constexpr int parse_concatenation() {
+        auto node = add(Node{ Node::Empty });
+        while (!at_end() && peek() != '|' && peek() != ')' && !at_anchoring_dollar()) {
+            const auto next = parse_repeat();
+            node = add(Node{ Node::Concat, {}, node, next });
+        }
+        return node;
+    }
+
+    constexpr int parse_number() {
+        if (at_end() || peek() < '0' || peek() > '9') {
+            throw std::invalid_argument{ "dfa: expected a number in {}" };
+        }
+        int value{};
+        while (!at_end() && peek() >= '0' && peek() <= '9') {
+            value = value * 10 + (pattern[pos++] - '0');
+            if (value > 1000) {
+                throw std::invalid_argument{ "dfa: repetition count too large" };
+            }
+        }
+        return value;
+    }
+
+    constexpr int parse_repeat() {
+        auto atom = parse_atom();
+        while (!at_end()) {
+            int min{}, max{};
+            const auto c = peek();
+            if (c == '*') { min = 0; max = -1; pos++; }
+            else if (c == '+') { min = 1; max = -1; pos++; }
+            else if (c == '?') { min = 0; max = 1; pos++; }
+            else if (c == '{') {
+                pos++;
+                min = max = parse_number();
+                if (!at_end() && peek() == ',') {
+                    pos++;
+                    max = !at_end() && peek() == '}' ? -1 : parse_number();
+                }
+                if (at_end() || pattern[pos++] != '}' || (max != -1 && max < min)) {
+                    throw std::invalid_argument{ "dfa: malformed {n,m}" };
+                }
+            } else {
+                break;
+            }
+            if (!at_end() && peek() == '?') {
+                throw std::invalid_argument{ "dfa: lazy quantifiers are not supported" };
+            }
+            atom = add(Node{ Node::Repeat, {}, atom, -1, min, max });
+        }
+        return atom;
+    }
+
+    // \d \w \s and their negations
+    static constexpr bool class_escape(char c, ByteSet& set) {
+        ByteSet escaped;
+        switch (c) {
+            case 'd': case 'D': escaped.add_range('0', '9'); break;
+            case 'w': case 'W':
+                escaped.add_range('a', 'z'); escaped.add_range('A', 'Z'); escaped.add_range('0', '9'); escaped.add('_');
+                break;
+            case 's': case 'S': for (char space : { ' ', '\t', '\n', '\r', '\f', '\v' }) escaped.add(static_cast<unsigned char>(space)); break;
+            default: return false;
+        }
+        if (c == 'D' || c == 'W' || c == 'S') {
+            escaped.invert();
+        }
+        set.merge(escaped);
+        return true;
+    }
+
+    static constexpr unsigned char literal_escape(char c) {
+        switch (c) {
+            case 'n': return '\n';
+            case 't': return '\t';
+            case 'r': return '\r';
+            case 'f': return '\f';
+            case 'v': return '\v';
+            case '0': return '\0';
+            case 'b': case 'B': throw std::invalid_argument{ "dfa: word boundaries are not supported" };
+            default:
+                if (c >= '1' && c <= '9') throw std::invalid_argument{ "dfa: backreferences are not supported" };
+                return static_cast<unsigned char>(c);
+        }
+    }
+
+    constexpr int parse_class() {
+        ByteSet set;
+        const bool negate = !at_end() && peek() == '^';
+        if (negate) pos++;
+        bool first = true;
+        while (!at_end() && (peek() != ']' || first)) {
+            first = false;
+            auto c = pattern[pos++];
+            unsigned char lo{};
+            if (c == '\\') {
+                if (at_end()) break;
+                c = pattern[pos++];
+                if (class_escape(c, set)) continue;
+                lo = literal_escape(c);
+            } else {
+                lo = static_cast<unsigned char>(c);
+            }
+            if (pos + 1 < pattern.size() && peek() == '-' && pattern[pos + 1] != ']') {
+                pos++;
+                auto hi_char = pattern[pos++];
+                const auto hi = hi_char == '\\' && !at_end() ? literal_escape(pattern[pos++]) : static_cast<unsigned char>(hi_char);
+                if (hi < lo) throw std::invalid_argument{ "dfa: reversed range in []" };
+                set.add_range(lo, hi);
+            } else {
+                set.add(lo);
+            }
+        }
+        if (at_end()) {
+            throw std::invalid_argument{ "dfa: missing ']'" };
+        }
+        pos++;
+        if (negate) set.invert();
+        return add(Node{ Node::Set, set });
+    }
+
+    constexpr int parse_atom() {
+        const auto c = pattern[pos++];
+        ByteSet set;
+        switch (c) {
+            case '(': {
+                if (pos + 1 < pattern.size() && peek() == '?' && pattern[pos + 1] == ':') {
+                    pos += 2;
+                } else if (!at_end() && peek() == '?') {
+                    throw std::invalid_argument{ "dfa: lookaround is not supported" };
+                }
+                depth++;
+                const auto inner = parse_alternation();
+                depth--;
+                if (at_end() || pattern[pos++] != ')') {
+                    throw std::invalid_argument{ "dfa: missing ')'" };
+                }
+                return inner;
+            }
+            case '[':
+                return parse_class();
+            case '.':
+                // ECMAScript's . stops at line terminators; of those, bytes can only spell \n and \r
+                set.add('\n');
+                set.add('\r');
+                set.invert();
+                return add(Node{ Node::Set, set });
+            case '\\':
+                if (at_end()) throw std::invalid_argument{ "dfa: trailing backslash" };
+                if (!class_escape(pattern[pos], set)) set.add(literal_escape(pattern[pos]));
+                pos++;
+                return add(Node{ Node::Set, set });
+            case '*': case '+': case '?': case '{':
+                throw std::invalid_argument{ "dfa: quantifier without anything to repeat" };
+            case '^': case '$':
+                throw std::invalid_argument{ "dfa: ^ and $ are only supported at the ends of a top-level alternative" };
+            default:
+                set.add(static_cast<unsigned char>(c));
+                return add(Node{ Node::Set, set });
+        }
+    }
+
+    std::string_view pattern;
+    size_t pos{};
+    int depth{};  // open groups
+};
+
+// A set of NFA states, one bit each
+struct StateSet {
+    std::vector<uint64_t> bits;
+
+    constexpr explicit StateSet(size_t n_states = 0) : bits((n_states + 63) / 64) { }
+    constexpr bool has(size_t s) const { return (bits[s / 64] >> (s % 64)) & 1; }
+    constexpr void add(size_t s) { bits[s / 64] |= uint64_t{ 1 } << (s % 64); }
+    constexpr bool empty() const {
+        for (auto word : bits) {
+            if (word) return false;
+        }
+        return true;
+    }
+    constexpr void merge(const StateSet& other) {
+        for (size_t i{}; i < bits.size(); i++) bits[i] |= other.bits[i];
+    }
+    constexpr void remove(const StateSet& other) {
+        for (size_t i{}; i < bits.size(); i++) bits[i] &= ~other.bits[i];
+    }
+    constexpr bool operator==(const StateSet&) const = default;
+};
+
+// Thompson construction: every node becomes a fragment from a given state to the state it returns
+struct Nfa {
+    std::vector<ByteSet> edge_set;
+    std::vector<int> edge_from, edge_to;
+    std::vector<std::vector<int>> epsilon;
+    int accept{}, accept_at_end{};  // the latter only counts at the end of the text ($)
+
+    constexpr int new_state() {
+        epsilon.emplace_back();
+        return static_cast<int>(epsilon.size()) - 1;
+    }
+    constexpr void add_epsilon(int from, int to) { epsilon[static_cast<size_t>(from)].push_back(to); }
+
+    constexpr int build(const std::vector<Node>& nodes, int index, int from) {
+        const auto& node = nodes[static_cast<size_t>(index)];
+        switch (node.kind) {
+            case Node::Empty:
+                return from;
+            case Node::Set: {
+                const auto to = new_state();
+                edge_set.push_back(node.set);
+                edge_from.push_back(from);
+                edge_to.push_back(to);
+                return to;
+            }
+            case Node::Concat:
+                return build(nodes, node.right, build(nodes, node.left, from));
+            case Node::Alternate: {
+                const auto left = build(nodes, node.left, from);
+                const auto right = build(nodes, node.right, from);
+                const auto join = new_state();
+                add_epsilon(left, join);
+                add_epsilon(right, join);
+                return join;
+            }
+            case Node::Repeat: {
+                for (int i{}; i < node.min; i++) {
+                    from = build(nodes, node.left, from);
+                }
+                if (node.max == -1) {
+                    const auto loop = new_state();
+                    add_epsilon(from, loop);
+                    add_epsilon(build(nodes, node.left, loop), loop);
+                    const auto end = new_state();
+                    add_epsilon(loop, end);
+                    return end;
+                }
+                const auto end = new_state();
+                for (int i { node.min }; i < node.max; i++) {
+                    add_epsilon(from, end);
+                    from = build(nodes, node.left, from);
+                }
+                add_epsilon(from, end);
+                return end;
+            }
+        }
+        return from;
+    }
+
+    constexpr StateSet closure(const StateSet& states) const {
+        auto set = states;
+        std::vector<int> stack;
+        for (size_t s{}; s < epsilon.size(); s++) {
+            if (set.has(s)) stack.push_back(static_cast<int>(s));
+        }
+        while (!stack.empty()) {
+            const auto s = static_cast<size_t>(stack.back());
+            stack.pop_back();
+            for (auto to : epsilon[s]) {
+                if (!set.has(static_cast<size_t>(to))) {
+                    set.add(static_cast<size_t>(to));
+                    stack.push_back(to);
+                }
+            }
+        }
+        return set;
+    }
+    constexpr StateSet closure_of(std::initializer_list<int> states) const {
+        StateSet set{ epsilon.size() };
+        for (auto s : states) set.add(static_cast<size_t>(s));
+        return closure(set);
+    }
+    // The states `set` reaches by consuming `byte`
+    constexpr StateSet step(const StateSet& set, unsigned char byte) const {
+        StateSet target{ epsilon.size() };
+        for (size_t e{}; e < edge_set.size(); e++) {
+            if (set.has(static_cast<size_t>(edge_from[e])) && edge_set[e].has(byte)) {
+                target.add(static_cast<size_t>(edge_to[e]));
+            }
+        }
+        return closure(target);
+    }
+
+    // Same automaton with every edge turned around: it reads the text backwards
+    constexpr Nfa reversed() const {
+        Nfa result;
+        result.edge_set = edge_set;
+        result.edge_from = edge_to;
+        result.edge_to = edge_from;
+        result.epsilon.resize(epsilon.size());
+        for (size_t s{}; s < epsilon.size(); s++) {
+            for (auto to : epsilon[s]) result.epsilon[static_cast<size_t>(to)].push_back(static_cast<int>(s));
+        }
+        return result;
+    }
+};
+
+// accepting[] bits: a match ends in this state / it ends here if this is the edge of the text - the end for the
+// forward automata, the beginning for the reverse one
+inline constexpr uint8_t accepts_here { 1 }, accepts_at_edge { 2 };
+
+// One DFA in flat arrays. State 0 is the dead state (no match possible any more).
+struct Automaton {
+    std::vector<uint16_t> next;  // [state * classes + class]
+    std::vector<uint8_t> accepting;
+
+    constexpr size_t states() const { return accepting.size(); }
+};
+
+/*
+    Three DFAs over the same byte classes. In each, state 1 starts at the edge of the text the automaton starts
+    reading from and *_inside anywhere else (they differ when an alternative has ^ or $).
+        - forward: the pattern itself, for match().
+        - leftmost: for search(). A new thread starts at every position, and threads are kept in groups by the
+          position they started at. Once a group matches, the later ones are dropped and no new ones start, so the
+          last position this DFA accepts is where the leftmost-longest match ends. It dies when that match can't
+          grow any more. leftmost_inside is the state with nothing in flight.
+        - reverse: the pattern read backwards, run from the end of the match to the earliest start that reaches it.
+*/
+struct CompiledPattern {
+    std::array<uint8_t, 256> byte_class{};
+    size_t classes{};
+    Automaton forward, leftmost, reverse;
+    uint16_t leftmost_inside{}, reverse_inside{};
+    std::string prefix;  // every match not at the beginning of the text starts with this literal
+    std::array<uint8_t, 256> first_byte{};
+    bool use_first_byte{};
+};
+
+// A leftmost DFA state: the live NFA states grouped by where their thread started, earliest first
+struct Threads {
+    std::vector<StateSet> groups;
+    bool matched{};  // the last group has matched, so no later start can win
+
+    constexpr bool operator==(const Threads&) const = default;
+};
+
+template <typename State>
+constexpr size_t find_or_add(std::vector<State>& states, const State& state) {
+    constexpr size_t max_states { 4096 };
+    size_t id{};
+    while (id < states.size() && states[id] != state) id++;
+    if (id == states.size()) {
+        if (states.size() == max_states) throw std::invalid_argument{ "dfa: pattern needs too many states" };
+        states.push_back(state);
+    }
+    return id;
+}
+
+// Subset construction: numbers every state reachable from `states` (the dead state, then the starts)
+template <typename State, typename Step, typename Flags>
+constexpr Automaton determinize(std::vector<State> states, const std::array<int, 256>& representative, size_t classes,
+                                Step step, Flags flags) {
+    Automaton automaton;
+    for (size_t d { 1 }; d < states.size(); d++) {
+        automaton.next.resize(states.size() * classes);
+        for (size_t c{}; c < classes; c++) {
+            const auto id = find_or_add(states, step(states[d], static_cast<unsigned char>(representative[c])));
+            automaton.next[d * classes + c] = static_cast<uint16_t>(id);
+        }
+    }
+    for (const auto& state : states) {
+        automaton.accepting.push_back(flags(state));
+    }
+    return automaton;
+}
+
+constexpr CompiledPattern compile(std::string_view pattern) {
+    Parser parser{ pattern };
+    parser.parse();
+
+    // NFA state 0 starts anywhere; state 1 only at the beginning of the text, where everything else may start too
+    Nfa nfa;
+    const auto start_anywhere = nfa.new_state();
+    const auto start_at_beginning = nfa.new_state();
+    nfa.add_epsilon(start_at_beginning, start_anywhere);
+    nfa.accept = nfa.new_state();
+    nfa.accept_at_end = nfa.new_state();
+    bool any_unanchored_start{}, any_unanchored_end{};
+    for (const auto& alternative : parser.alternatives) {
+        const auto end = nfa.build(parser.nodes, alternative.root, alternative.at_start ? start_at_beginning : start_anywhere);
+        nfa.add_epsilon(end, alternative.at_end ? nfa.accept_at_end : nfa.accept);
+        any_unanchored_start |= !alternative.at_start;
+        any_unanchored_end |= !alternative.at_end;
+    }
+    const auto n_states = nfa.epsilon.size();
+
+    CompiledPattern compiled;
+
+    // Byte classes: two bytes share a class when every edge either takes both or neither
+    std::array<int, 256> representative{};
+    for (unsigned b{}; b < 256; b++) {
+        size_t c{};
+        for (; c < compiled.classes; c++) {
+            const auto other = static_cast<unsigned char>(representative[c]);
+            bool same = true;
+            for (const auto& set : nfa.edge_set) {
+                if (set.has(static_cast<unsigned char>(b)) != set.has(other)) {
+                    same = false;
+                    break;
+                }
+            }
+            if (same) break;
+        }
+        if (c == compiled.classes) {
+            representative[compiled.classes++] = static_cast<int>(b);
+        }
+        compiled.byte_class[b] = static_cast<uint8_t>(c);
+    }
+    auto flags = [](bool here, bool at_edge) -> uint8_t {
+        return here ? accepts_here | accepts_at_edge : at_edge ? accepts_at_edge : 0;
+    };
+    const auto accept = static_cast<size_t>(nfa.accept), accept_at_end = static_cast<size_t>(nfa.accept_at_end);
+    StateSet anywhere{ n_states };
+    if (any_unanchored_start) anywhere = nfa.closure_of({ start_anywhere });
+
+    // (push_back rather than initializer lists: GCC frees their elements too early in constant evaluation)
+    std::vector<StateSet> sets;
+    sets.emplace_back(n_states);
+    sets.push_back(nfa.closure_of({ start_at_beginning }));
+    const auto forward_inside = find_or_add(sets, anywhere);
+    compiled.forward = determinize(std::move(sets), representative, compiled.classes,
+        [&](const StateSet& set, unsigned char byte) { return nfa.step(set, byte); },
+        [&](const StateSet& set) { return flags(set.has(accept), set.has(accept_at_end)); });
+
+    // The first group that has reached accept wins; everything after it goes
+    auto settle = [&](Threads threads) {
+        for (size_t g{}; g < threads.groups.size(); g++) {
+            if (threads.groups[g].has(accept)) {
+                threads.groups.resize(g + 1);
+                threads.matched = true;
+            }
+        }
+        if (threads.groups.empty()) threads.matched = false;  // dead
+        return threads;
+    };
+    auto single_group = [&](const StateSet& group) {
+        Threads threads;
+        if (!group.empty()) threads.groups.push_back(group);
+        return settle(std::move(threads));
+    };
+    auto leftmost_step = [&](const Threads& threads, unsigned char byte) {
+        Threads result{ {}, threads.matched };
+        StateSet seen{ n_states };
+        auto add_group = [&](StateSet group) {
+            group.remove(seen);  // a thread that started earlier is in that NFA state already
+            if (group.empty()) return;
+            seen.merge(group);
+            result.groups.push_back(std::move(group));
+        };
+        for (const auto& group : threads.groups) add_group(nfa.step(group, byte));
+        if (!threads.matched) add_group(anywhere);
+        return settle(std::move(result));
+    };
+    std::vector<Threads> threads;
+    threads.emplace_back();
+    threads.push_back(single_group(nfa.closure_of({ start_at_beginning })));
+    compiled.leftmost_inside = static_cast<uint16_t>(find_or_add(threads, single_group(anywhere)));
+    compiled.leftmost = determinize(std::move(threads), representative, compiled.classes, leftmost_step,
+        [&](const Threads& threads) {
+            bool here{}, at_edge{};
+            for (const auto& group : threads.groups) {
+                here |= group.has(accept);
+                at_edge |= group.has(accept_at_end);
+            }
+            return flags(here, at_edge);
+        });
+
+    const auto backwards = nfa.reversed();
+    StateSet inside{ n_states };
+    if (any_unanchored_end) inside = backwards.closure_of({ nfa.accept });
+    sets.clear();
+    sets.emplace_back(n_states);
+    sets.push_back(backwards.closure_of({ nfa.accept_at_end }));
+    sets[1].merge(inside);
+    compiled.reverse_inside = static_cast<uint16_t>(find_or_add(sets, inside));
+    compiled.reverse = determinize(std::move(sets), representative, compiled.classes,
+        [&](const StateSet& set, unsigned char byte) { return backwards.step(set, byte); },
+        [&](const StateSet& set) {
+            return flags(set.has(static_cast<size_t>(start_anywhere)), set.has(static_cast<size_t>(start_at_beginning)));
+        });
+
+    // Literal prefix: follow the start state while exactly one byte keeps the match alive
+    const auto& forward = compiled.forward;
+    auto state = forward_inside;
+    while (state != 0 && compiled.prefix.size() < 64 && !forward.accepting[state]) {
+        int only{ -1 }, live{};
+        for (unsigned b{}; b < 256 && live < 2; b++) {
+            if (forward.next[state * compiled.classes + compiled.byte_class[b]] != 0) {
+                only = static_cast<int>(b);
+                live++;
+            }
+        }
+        if (live != 1) break;
+        compiled.prefix.push_back(static_cast<char>(only));
+        state = forward.next[state * compiled.classes + compiled.byte_class[static_cast<unsigned>(only)]];
+    }
+    compiled.use_first_byte = forward_inside != 0 && !forward.accepting[forward_inside];
+    for (unsigned b{}; b < 256; b++) {
+        compiled.first_byte[b] = forward.next[forward_inside * compiled.classes + compiled.byte_class[b]] != 0;
+    }
+    return compiled;
+}
+
+// Non-owning view of either a compile-time or a cached runtime DFA; all the algorithms run on this
+struct DfaView {
+    struct Table {
+        const uint16_t* next;
+        const uint8_t* accepting;
+    };
+    const uint8_t* byte_class;
+    size_t classes;
+    Table forward, leftmost, reverse;
+    size_t leftmost_inside, reverse_inside;
+    std::string_view prefix;
+    const uint8_t* first_byte;
+    bool use_first_byte;
+
+    constexpr size_t step(const Table& table, size_t state, char c) const {
+        return table.next[state * classes + byte_class[static_cast<unsigned char>(c)]];
+    }
+};
+
+constexpr DfaView view(const CompiledPattern& compiled) {
+    return { compiled.byte_class.data(), compiled.classes,
+             { compiled.forward.next.data(), compiled.forward.accepting.data() },
+             { compiled.leftmost.next.data(), compiled.leftmost.accepting.data() },
+             { compiled.reverse.next.data(), compiled.reverse.accepting.data() },
+             compiled.leftmost_inside, compiled.reverse_inside,
+             compiled.prefix, compiled.first_byte.data(), compiled.use_first_byte };
+}
+
+struct Match {
+    size_t position;
+    size_t length;
+};
+
+constexpr bool match(std::string_view text, const DfaView& dfa) {
+    size_t state { 1 };
+    for (auto c : text) {
+        state = dfa.step(dfa.forward, state, c);
+        if (state == 0) return false;
+    }
+    return dfa.forward.accepting[state] & accepts_at_edge;
+}
+
+// Leftmost match starting at or after `from`, extended as far as it goes. The leftmost DFA runs forward to where
+// that match ends, the reverse DFA back from there to where it starts: every byte is read at most twice.
+constexpr std::optional<Match> search(std::string_view text, const DfaView& dfa, size_t from = 0) {
+    constexpr auto npos = std::string_view::npos;
+    auto state = from == 0 ? size_t{ 1 } : dfa.leftmost_inside;
+    auto end = dfa.leftmost.accepting[state] & accepts_here ? from : npos;
+    auto i = from;
+    for (; i < text.size() && state != 0; i++) {
+        // with nothing in flight, jump to where the prefilter says a match could start
+        if (state == dfa.leftmost_inside) {
+            if (!dfa.prefix.empty()) {
+                i = text.find(dfa.prefix, i);
+                if (i == npos) return std::nullopt;
+            } else if (dfa.use_first_byte) {
+                while (i < text.size() && !dfa.first_byte[static_cast<unsigned char>(text[i])]) i++;
+                if (i == text.size()) break;
+            }
+        }
+        state = dfa.step(dfa.leftmost, state, text[i]);
+        if (dfa.leftmost.accepting[state] & accepts_here) end = i + 1;
+    }
+    // $ alternatives only count when a thread is still alive at the end of the text
+    if (i == text.size() && dfa.leftmost.accepting[state] & accepts_at_edge) {
+        end = text.size();
+    }
+    if (end == npos) {
+        return std::nullopt;
+    }
+
+    auto back = end == text.size() ? size_t{ 1 } : dfa.reverse_inside;
+    auto accepts = [&](size_t position) {
+        return dfa.reverse.accepting[back] & (position == 0 ? accepts_at_edge : accepts_here);
+    };
+    auto start = accepts(end) ? end : npos;
+    for (auto j = end; j > from && back != 0; j--) {
+        back = dfa.step(dfa.reverse, back, text[j - 1]);
+        if (accepts(j - 1)) start = j - 1;
+    }
+    return Match{ start, end - start };
+}
+
+// Replaces every match with the literal replacement (no $& / $1 substitution); empty matches insert between characters
+inline std::string replace(std::string_view text, const DfaView& dfa, std::string_view replacement) {
+    std::string result;
+    result.reserve(text.size());
+    size_t pos{};
+    while (pos <= text.size()) {
+        const auto found = search(text, dfa, pos);
+        if (!found) break;
+        result.append(text.substr(pos, found->position - pos));
+        result.append(replacement);
+        pos = found->position + found->length;
+        if (found->length == 0) {
+            if (pos < text.size()) result.push_back(text[pos]);
+            pos++;
+        }
+    }
+    if (pos < text.size()) result.append(text.substr(pos));
+    return result;
+}
+
+// CompiledPattern uses vectors, which can't outlive constant evaluation, so its contents are copied into arrays
+// sized by a first compile() run.
+template <size_t States, size_t Classes>
+struct StaticAutomaton {
+    std::array<uint16_t, States * Classes> next{};
+    std::array<uint8_t, States> accepting{};
+
+    constexpr void assign(const Automaton& automaton) {
+        for (size_t i{}; i < next.size(); i++) next[i] = automaton.next[i];
+        for (size_t i{}; i < States; i++) accepting[i] = automaton.accepting[i];
+    }
+    constexpr DfaView::Table table() const { return { next.data(), accepting.data() }; }
+};
+
+template <size_t ForwardStates, size_t LeftmostStates, size_t ReverseStates, size_t Classes, size_t PrefixLength>
+struct StaticPattern {
+    std::array<uint8_t, 256> byte_class{};
+    StaticAutomaton<ForwardStates, Classes> forward;
+    StaticAutomaton<LeftmostStates, Classes> leftmost;
+    StaticAutomaton<ReverseStates, Classes> reverse;
+    uint16_t leftmost_inside{}, reverse_inside{};
+    std::array<char, PrefixLength + 1> prefix{};
+    std::array<uint8_t, 256> first_byte{};
+    bool use_first_byte{};
+
+    constexpr DfaView view() const {
+        return { byte_class.data(), Classes, forward.table(), leftmost.table(), reverse.table(),
+                 leftmost_inside, reverse_inside,
+                 std::string_view{ prefix.data(), PrefixLength }, first_byte.data(), use_first_byte };
+    }
+};
+
+template <FixedString Pattern>
+constexpr auto build_static() {
+    constexpr auto sizes = [] {
+        const auto compiled = compile(Pattern.view());
+        return std::array{ compiled.forward.states(), compiled.leftmost.states(), compiled.reverse.states(),
+                           compiled.classes, compiled.prefix.size() };
+    }();
+    const auto compiled = compile(Pattern.view());
+    StaticPattern<sizes[0], sizes[1], sizes[2], sizes[3], sizes[4]> result;
+    result.byte_class = compiled.byte_class;
+    result.forward.assign(compiled.forward);
+    result.leftmost.assign(compiled.leftmost);
+    result.reverse.assign(compiled.reverse);
+    result.leftmost_inside = compiled.leftmost_inside;
+    result.reverse_inside = compiled.reverse_inside;
+    for (size_t i{}; i < sizes[4]; i++) result.prefix[i] = compiled.prefix[i];
+    result.first_byte = compiled.first_byte;
+    result.use_first_byte = compiled.use_first_byte;
+    return result;
+}
+
+template <FixedString Pattern>
+inline constexpr auto static_pattern = build_static<Pattern>();
+
+template <FixedString Pattern>
+constexpr bool match(std::string_view text) { return match(text, static_pattern<Pattern>.view()); }
+
+template <FixedString Pattern>
+constexpr std::optional<Match> search(std::string_view text) { return search(text, static_pattern<Pattern>.view()); }
+
+template <FixedString Pattern>
+std::string replace(std::string_view text, std::string_view replacement) {
+    return replace(text, static_pattern<Pattern>.view(), replacement);
+}
+
+// Process-wide cache for runtime pattern strings: compiled once, then shared (entries are never evicted)
+class PatternCache {
+public:
+    static PatternCache& instance() {
+        static PatternCache cache;
+        return cache;
+    }
+
+    const CompiledPattern& get(std::string_view pattern) {
+        {
+            std::shared_lock<std::shared_mutex> guard{ lock };
+            if (const auto found = patterns.find(pattern); found != patterns.end()) {
+                return *found->second;
+            }
+        }
+        auto compiled = std::make_unique<CompiledPattern>(compile(pattern));  // compile outside the lock
+        std::unique_lock<std::shared_mutex> guard{ lock };
+        return *patterns.try_emplace(std::string{ pattern }, std::move(compiled)).first->second;
+    }
+
+    size_t size() {
+        std::shared_lock<std::shared_mutex> guard{ lock };
+        return patterns.size();
+    }
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+    };
+    std::shared_mutex lock;
+    std::unordered_map<std::string, std::unique_ptr<CompiledPattern>, Hash, std::equal_to<>> patterns;
+};
+
+inline bool match(std::string_view text, std::string_view pattern) {
+    return match(text, view(PatternCache::instance().get(pattern)));
+}
+inline std::optional<Match> search(std::string_view text, std::string_view pattern) {
+    return search(text, view(PatternCache::instance().get(pattern)));
+}
+inline std::string replace(std::string_view text, std::string_view pattern, std::string_view replacement) {
+    return replace(text, view(PatternCache::instance().get(pattern)), replacement);
+}
+
+} // namespace dfa
+
+// Compile-time patterns can be checked at compile time, too
+static_assert(dfa::match<R"((\w{2})?(\d{5})(-\d{4})?)">("OH43206-0001"));
+static_assert(!dfa::match<R"((\w{2})?(\d{5})(-\d{4})?)">("Columbus OH South Side"));
+
+// The regex sections above, on dfa (whole-match only: the engine has no capture groups)
+TEST_CASE("dfa") {
+    SECTION("match returns true given matching string") {
+        REQUIRE(dfa::match<R"((\w{2})?(\d{5})(-\d{4})?)">("OH43206-0001"));
+        REQUIRE(dfa::match<R"((\w{2})?(\d{5})(-\d{4})?)">("43206"));
+        REQUIRE(dfa::match("OH43206-0001", R"((\w{2})?(\d{5})(-\d{4})?)"));
+    }
+    SECTION("match returns false when string does not match") {
+        REQUIRE_FALSE(dfa::match<R"((\w{2})?(\d{5})(-\d{4})?)">("Columbus OH South Side"));
+        REQUIRE_FALSE(dfa::match("Columbus OH South Side", R"((\w{2})?(\d{5})(-\d{4})?)"));
+    }
+    SECTION("search returns true when even part of a string matches") {
+        const std::string sentence("I live in zip code 43206-0001");
+        REQUIRE_FALSE(dfa::match<R"((\w{2})?(\d{5})(-\d{4})?)">(sentence));
+        const auto found = dfa::search<R"((\w{2})?(\d{5})(-\d{4})?)">(sentence);
+        REQUIRE(found);
+        REQUIRE(sentence.substr(found->position, found->length) == "43206-0001");
+        REQUIRE(dfa::search(sentence, R"(\d{5})"));
+    }
+    SECTION("replace replaces matched instances in a string") {
+        const std::string sentence("queueing and cooeeing in eutopia");
+        REQUIRE(dfa::replace<"[aeiou]">(sentence, "_") == "q_____ng _nd c_____ng _n __t_p__");
+        REQUIRE(dfa::replace(sentence, "[aeiou]", "_") == "q_____ng _nd c_____ng _n __t_p__");
+    }
+    SECTION("anchors, literal prefixes and empty matches") {
+        REQUIRE(dfa::search<"^ERROR">("ERROR disk full"));
+        REQUIRE_FALSE(dfa::search<"^ERROR">("no ERROR here"));
+        REQUIRE(dfa::search<"full$">("ERROR disk full"));
+        REQUIRE_FALSE(dfa::search<"disk$">("ERROR disk full"));
+        REQUIRE(dfa::search<"^a|b">("xb"));  // ^ and $ bind to their own alternative only
+        REQUIRE(dfa::search<"a|b$">("ax"));
+        REQUIRE_FALSE(dfa::search<"^a|b$">("xax"));
+        const auto found = dfa::search<"b+|a+c">("xaabbb");
+        REQUIRE((found && found->position == 3 && found->length == 3));
+        REQUIRE(dfa::static_pattern<"ERROR [0-9]+">.view().prefix == "ERROR ");
+        REQUIRE(dfa::replace<"x*">("abc", "-") == std::regex_replace(std::string{ "abc" }, std::regex{ "x*" }, "-"));
+    }
+    SECTION("search is linear in the text") {
+        // retrying from every position read 200k * 200k / 2 bytes here
+        std::string text(200'000, 'a');
+        REQUIRE_FALSE(dfa::search<"a*b">(text));
+        text.back() = 'b';
+        const auto found = dfa::search<"a+c|b">(text);
+        REQUIRE((found && found->position == text.size() - 1));
+        REQUIRE(dfa::search<"a*b">(text)->length == text.size());
+    }
+    SECTION("the runtime cache compiles each pattern once") {
+        const auto& first = dfa::PatternCache::instance().get("cache[0-9]+me");
+        const auto before = dfa::PatternCache::instance().size();
+        const auto& second = dfa::PatternCache::instance().get(std::string{ "cache[0-9]+me" });
+        REQUIRE(&first == &second);
+        REQUIRE(dfa::PatternCache::instance().size() == before);
+    }
+    SECTION("unsupported syntax is rejected") {
+        REQUIRE_THROWS_AS(dfa::compile("(a"), std::invalid_argument);
+        REQUIRE_THROWS_AS(dfa::compile("a+?"), std::invalid_argument);
+        REQUIRE_THROWS_AS(dfa::compile(R"((a)\1)"), std::invalid_argument);
+        REQUIRE_THROWS_AS(dfa::compile("[a-"), std::invalid_argument);
+        REQUIRE_THROWS_AS(dfa::compile("(^a|b)"), std::invalid_argument);
+        REQUIRE_THROWS_AS(dfa::compile("a$b"), std::invalid_argument);
+    }
+    SECTION("agrees with std::regex_match on random inputs") {
+        const char* patterns[] { "(ab|a)*b?", "[a-c]{2,3}(x|yz)*", "a(b|c)*d+|e", R"(\d+(\.\d{1,2})?)", "(a|b)*abb", "[^a]b.?",
+                               "^a|b", "a|b$", "^(ab|c)+$|x", "b|^$" };
+        uint32_t seed { 12345 };
+        auto random = [&] { seed = seed * 1664525 + 1013904223; return seed >> 8; };
+        const char alphabet[] { 'a', 'b', 'c', 'd', 'e', 'x', 'y', 'z', '1', '.', '\n', '\r' };
+        for (auto pattern : patterns) {
+            const std::regex reference{ pattern };
+            const auto& compiled = dfa::PatternCache::instance().get(pattern);
+            for (int i{}; i < 2000; i++) {
+                std::string text(random() % 8, ' ');
+                for (auto& c : text) c = alphabet[random() % sizeof(alphabet)];
+                INFO("pattern " << pattern << " text '" << text << "'");
+                REQUIRE(dfa::match(text, dfa::view(compiled)) == std::regex_match(text, reference));
+                std::smatch expected;
+                const auto found = dfa::search(text, dfa::view(compiled));
+                REQUIRE(found.has_value() == std::regex_search(text, expected, reference));
+                if (found) {
+                    // same leftmost start; the POSIX match may be longer
+                    REQUIRE(found->position == static_cast<size_t>(expected.position()));
+                    REQUIRE(found->length >= static_cast<size_t>(expected.length()));
+                }
+            }
+        }
+    }
+}
+
+/*
+    Same log lines through std::regex and dfa: 200k lines, a few with zip codes and errors.
+    Hidden by the leading dot; run with: ./ccc-15 "[.benchmark]"
+*/
+TEST_CASE("dfa vs std::regex", "[.benchmark]") {
+    std::vector<std::string> lines;
+    for (int i{}; i < 200'000; i++) {
+        std::string line = "2024-05-0" + std::to_string(i % 9 + 1) + " 12:34:56 INFO request " + std::to_string(i * 7919 % 100000) +
+                           " served in " + std::to_string(i % 250) + "ms for user" + std::to_string(i % 1000);
+        if (i % 50 == 0) line += " ERROR 500 at OH43206-0001";
+        lines.push_back(std::move(line));
+    }
+    auto time = [&](const char* name, auto&& per_line) {
+        size_t hits{};
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& line : lines) hits += per_line(line);
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-44s %8.1f ns/line (%zu hits)\n", name, elapsed.count() / lines.size(), hits);
+    };
+
+    const std::regex zip{ R"((\w{2})?(\d{5})(-\d{4})?)" };
+    const std::regex error{ "ERROR [0-9]+" };
+    const std::regex vowels{ "[aeiou]" };
+    time("std::regex_search zip", [&](const std::string& line) { return std::regex_search(line, zip); });
+    time("dfa::search<zip>", [&](const std::string& line) { return dfa::search<R"((\w{2})?(\d{5})(-\d{4})?)">(line).has_value(); });
+    time("std::regex_search \"ERROR [0-9]+\"", [&](const std::string& line) { return std::regex_search(line, error); });
+    time("dfa::search<\"ERROR [0-9]+\"> (prefix find)", [&](const std::string& line) { return dfa::search<"ERROR [0-9]+">(line).has_value(); });
+    time("dfa::search(line, \"ERROR [0-9]+\") cached", [&](const std::string& line) { return dfa::search(line, "ERROR [0-9]+").has_value(); });
+    time("std::regex_replace vowels", [&](const std::string& line) { return std::regex_replace(line, vowels, "_").size(); });
+    time("dfa::replace<vowels>", [&](const std::string& line) { return dfa::replace<"[aeiou]">(line, "_").size(); });
+}
+
+/*
+    Micro-benchmarks for strings, conversions and the two pattern engines; hidden by [!benchmark].
+    Machine-readable results (mean, bounds and standard deviation per benchmark, in ns) come from the XML reporter:
+        ./ccc-15 "[!benchmark]" -r xml -o ccc-15-benchmarks.xml
+*/
+TEST_CASE("String and regex benchmarks", "[!benchmark]") {
+    const std::string line{ "2024-05-01 12:34:56 INFO request OH43206-0001 served in 17ms" };
+    const auto number = static_cast<int>(line.size()) * 9137;
+    const auto number_text = std::to_string(number);
+    const std::regex zip_regex{ R"((\w{2})?(\d{5})(-\d{4})?)" };
+    const std::regex vowels{ "[aeiou]" };
+
+    BENCHMARK("std::string short (SSO) construct") { return std::string{ line.data(), 10 }; };
+    BENCHMARK("std::string long construct") { return std::string{ line }; };
+    BENCHMARK("std::string += x16") {
+        std::string text;
+        for (int i{}; i < 16; i++) text += line;
+        return text.size();
+    };
+    BENCHMARK("std::to_string(int)") { return std::to_string(number); };
+    BENCHMARK("conv::to_string(int)") { return conv::to_string(number).size(); };
+    BENCHMARK("std::stoi") { return std::stoi(number_text); };
+    BENCHMARK("conv::parse<int>") { return *conv::parse<int>(number_text); };
+    BENCHMARK("std::regex construct") { return std::regex{ R"((\w{2})?(\d{5})(-\d{4})?)" }.mark_count(); };
+    BENCHMARK("dfa::PatternCache hit") { return &dfa::PatternCache::instance().get(R"((\w{2})?(\d{5})(-\d{4})?)"); };
+    BENCHMARK("std::regex_match") { return std::regex_match(line, zip_regex); };
+    BENCHMARK("dfa::match") { return dfa::match<R"((\w{2})?(\d{5})(-\d{4})?)">(line); };
+    BENCHMARK("std::regex_search") { return std::regex_search(line, zip_regex); };
+    BENCHMARK("dfa::search") { return dfa::search<R"((\w{2})?(\d{5})(-\d{4})?)">(line).has_value(); };
+    BENCHMARK("std::regex_replace") { return std::regex_replace(line, vowels, "_"); };
+    BENCHMARK("dfa::replace") { return dfa::replace<"[aeiou]">(line, "_"); };
 }
\ No newline at end of file
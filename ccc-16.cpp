@@ -3,6 +3,23 @@
 #include <sstream>
 #include <fstream>
 #include <bitset>
+#include <limits>
+#include <charconv>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <span>
+#include <cstring>
+#include <cstdio>
+#include <array>
+#include <memory>
+#include <string_view>
+#include <functional>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /*
     Streams: These model a stream of data flowing between objects, e.g. a file or network connection or the 
@@ -25,7 +42,473 @@
 
 using namespace std;
 
-int main() {
+/*
+    Fast numbers reader: `file >> value` goes through the locale, sentry objects and virtual streambuf calls for
+    every single integer. Instead, pull the file in 1 MiB blocks with read(), parse each token with std::from_chars
+    (no locale, no allocation) and fold max/min/sum/count in the same pass.
+        - Tokens are separated by whitespace. A token that isn't an integer is counted in `malformed` and skipped,
+          where `>>` would stop reading at it.
+        - summarize_numbers_file can split the file into byte ranges on newline boundaries and scan each range on its
+          own thread; the per-range stats are merged at the end.
+        - sum wraps around (mod 2^64) on overflow: signed overflow is undefined, so the additions are done in
+          unsigned long long and converted back, which is well-defined since C++20.
+*/
+struct NumberStats {
+    size_t count{};
+    size_t malformed{};
+    long long sum{};
+    long long min{ numeric_limits<long long>::max() };
+    long long max{ numeric_limits<long long>::min() };
+
+    static long long wrapping_add(long long a, long long b) {
+        return static_cast<long long>(static_cast<unsigned long long>(a) + static_cast<unsigned long long>(b));
+    }
+
+    void add(long long value) {
+        count++;
+        sum = wrapping_add(sum, value);
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+    }
+
+    void merge(const NumberStats& other) {
+        count += other.count;
+        malformed += other.malformed;
+        sum = wrapping_add(sum, other.sum);
+        min = other.min < min ? other.min : min;
+        max = other.max > max ? other.max : max;
+    }
+};
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Parses every whitespace-separated token in [begin, end)
+void scan_numbers(const char* begin, const char* end, NumberStats& stats) {
+    auto p = begin;
+    for (;;) {
+        while (p != end && is_space(*p)) {
+            p++;
+        }
+        if (p == end) {
+            return;
+        }
+        const auto token = p;
+        if (*p == '+') {
+            p++;  // from_chars doesn't take a leading plus; >> does
+        }
+        long long value;
+        const auto [next, error] = from_chars(p, end, value);
+        if (error == errc{} && (next == end || is_space(*next))) {
+            stats.add(value);
+            p = next;
+            continue;
+        }
+        stats.malformed++;
+        p = token;
+        while (p != end && !is_space(*p)) {
+            p++;
+        }
+    }
+}
+
+// Reads [begin, end) of the file in blocks; a token cut by the end of a block is carried over to the next one
+NumberStats scan_numbers_range(const char* path, streamoff begin, streamoff end) {
+    const size_t block_size { 1 << 20 };
+    NumberStats stats;
+    ifstream file{ path, ios::binary };
+    if (!file.is_open()) {
+        return stats;
+    }
+    file.seekg(begin);
+    vector<char> buffer(block_size);
+    size_t carried{};
+    for (auto remaining = end - begin; remaining > 0; ) {
+        if (carried == buffer.size()) {
+            buffer.resize(buffer.size() * 2);  // one token longer than a block
+        }
+        const auto wanted = static_cast<streamsize>(min<streamoff>(remaining, buffer.size() - carried));
+        file.read(buffer.data() + carried, wanted);
+        const auto got = file.gcount();
+        if (got <= 0) {
+            break;
+        }
+        remaining -= got;
+        const auto filled = buffer.data() + carried + got;
+        auto cut = filled;
+        if (remaining > 0) {
+            while (cut != buffer.data() && !is_space(cut[-1])) {
+                cut--;
+            }
+        }
+        scan_numbers(buffer.data(), cut, stats);
+        carried = static_cast<size_t>(filled - cut);
+        memmove(buffer.data(), cut, carried);
+    }
+    scan_numbers(buffer.data(), buffer.data() + carried, stats);
+    return stats;
+}
+
+// threads == 0 picks one per hardware thread; small files always get one
+NumberStats summarize_numbers_file(const char* path, size_t threads = 1) {
+    ifstream file{ path, ios::binary | ios::ate };
+    if (!file.is_open()) {
+        return NumberStats{};
+    }
+    const streamoff size = file.tellg();
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    threads = static_cast<size_t>(min<streamoff>(static_cast<streamoff>(threads), size / (1 << 20) + 1));
+
+    // Move each split point forward to just after the next newline, so every line belongs to exactly one range
+    vector<streamoff> bounds{ 0 };
+    for (size_t i { 1 }; i < threads; i++) {
+        auto at = max(bounds.back(), size * static_cast<streamoff>(i) / static_cast<streamoff>(threads));
+        file.seekg(at);
+        for (char c; at < size && file.get(c); at++) {
+            if (c == '\n') {
+                at++;
+                break;
+            }
+        }
+        bounds.push_back(at);
+    }
+    bounds.push_back(size);
+
+    vector<NumberStats> partial(threads);
+    vector<thread> workers;
+    for (size_t i { 1 }; i < threads; i++) {
+        workers.emplace_back([&, i] { partial[i] = scan_numbers_range(path, bounds[i], bounds[i + 1]); });
+    }
+    partial[0] = scan_numbers_range(path, bounds[0], bounds[1]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    NumberStats total;
+    for (const auto& stats : partial) {
+        total.merge(stats);
+    }
+    return total;
+}
+
+/*
+    Buffered batch writer: `file << value << endl` flushes (a write() system call) after every number. NumberWriter
+    formats with std::to_chars into its own 1 MiB buffer and hands full buffers to the stream in one write.
+    The buffer is flushed by flush() and by the destructor.
+*/
+class NumberWriter {
+public:
+    explicit NumberWriter(const char* path, ios::openmode mode = ios::out | ios::trunc)
+        : file{ path, mode | ios::binary }, buffer(1 << 20) { }
+    ~NumberWriter() { flush(); }
+    NumberWriter(const NumberWriter&) = delete;
+    NumberWriter& operator=(const NumberWriter&) = delete;
+
+    bool is_open() const { return file.is_open(); }
+
+    void write(long long value) {
+        // 20 digits + sign + newline
+        if (buffer.size() - used < 22) {
+            flush_buffer();
+        }
+        const auto [end, error] = to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+        *end = '\n';
+        used = static_cast<size_t>(end - buffer.data()) + 1;
+    }
+
+    void write(span<const long long> values) {
+        for (auto value : values) {
+            write(value);
+        }
+    }
+
+    void flush() {
+        flush_buffer();
+        file.flush();
+    }
+
+private:
+    void flush_buffer() {
+        file.write(buffer.data(), static_cast<streamsize>(used));
+        used = 0;
+    }
+
+    ofstream file;
+    vector<char> buffer;
+    size_t used{};
+};
+
+/*
+    Fast word counter for stdin: `cin >> word` builds a std::string per word (and cin is synced with stdio by default,
+    so it can't even buffer ahead). Counting words only needs the spots where a non-space follows a space.
+        - stdin is read with fread in 4 MiB blocks; nothing is copied per word.
+        - With SSE2, 64 bytes at a time become a 64-bit "is whitespace" mask; word starts are the bits where the
+          mask goes from space to non-space, counted with popcount. Otherwise a 256-entry table classifies bytes.
+        - Whitespace means the six characters isspace() accepts in the "C" locale - the same set >> skips - so the
+          count matches the `while (cin >> word)` loop.
+        - With frequencies, every word is looked up in an open-addressing table of string_views whose bytes live in a
+          chunked arena: each distinct word is copied once, repeats cost a hash and a compare. The partial word at the
+          end of a block is carried over so words never straddle blocks.
+*/
+constexpr array<bool, 256> make_space_table() {
+    array<bool, 256> table{};
+    for (unsigned char c : { ' ', '\t', '\n', '\v', '\f', '\r' }) {
+        table[c] = true;
+    }
+    return table;
+}
+constexpr auto space_table = make_space_table();
+
+class WordCounter {
+public:
+    void feed(const char* data, size_t n) {
+        size_t i{};
+#if defined(__SSE2__)
+        for (; i + 64 <= n; i += 64) {
+            const auto space = space_mask(data + i);
+            // a word starts where this byte isn't space and the byte before it was (bit 63 of the last chunk)
+            const auto before = (space << 1) | (previous_was_space ? 1 : 0);
+            words += static_cast<size_t>(__builtin_popcountll(~space & before));
+            previous_was_space = space >> 63;
+        }
+#endif
+        for (; i < n; i++) {
+            const bool space = space_table[static_cast<unsigned char>(data[i])];
+            words += previous_was_space && !space;
+            previous_was_space = space;
+        }
+    }
+
+    size_t count() const { return words; }
+
+private:
+#if defined(__SSE2__)
+    // ' ' or '\t'..'\r': subtracting '\t' turns the range check into one unsigned compare (c - 9 <= 4)
+    static uint64_t space_mask(const char* p) {
+        const auto blank = _mm_set1_epi8(' ');
+        const auto tab = _mm_set1_epi8('\t');
+        const auto range = _mm_set1_epi8(static_cast<char>('\r' - '\t'));
+        uint64_t mask{};
+        for (int lane{}; lane < 4; lane++) {
+            const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * lane));
+            const auto shifted = _mm_sub_epi8(bytes, tab);
+            const auto in_range = _mm_cmpeq_epi8(_mm_min_epu8(shifted, range), shifted);
+            const auto is_space = _mm_or_si128(in_range, _mm_cmpeq_epi8(bytes, blank));
+            mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(is_space))) << (16 * lane);
+        }
+        return mask;
+    }
+#endif
+    size_t words{};
+    bool previous_was_space{ true };
+};
+
+// Bump allocator in 1 MiB chunks: words are never freed one by one, only all together with the table
+class WordArena {
+public:
+    const char* store(string_view word) {
+        if (word.size() > chunk_size - used) {
+            chunks.push_back(make_unique<char[]>(max(chunk_size, word.size())));
+            used = 0;
+        }
+        const auto at = chunks.back().get() + used;
+        memcpy(at, word.data(), word.size());
+        used += word.size();
+        return at;
+    }
+private:
+    static constexpr size_t chunk_size { 1 << 20 };
+    vector<unique_ptr<char[]>> chunks;
+    size_t used{ chunk_size };
+};
+
+class WordFrequencies {
+public:
+    WordFrequencies() : slots(1024) { }
+
+    void add(string_view word) {
+        const auto hash = hasher(word);
+        for (auto i = hash & (slots.size() - 1); ; i = (i + 1) & (slots.size() - 1)) {
+            auto& slot = slots[i];
+            if (slot.count == 0) {
+                slot = Slot{ string_view{ arena.store(word), word.size() }, hash, 1 };
+                if (++used * 2 > slots.size()) {
+                    grow();
+                }
+                return;
+            }
+            if (slot.hash == hash && slot.word == word) {
+                slot.count++;
+                return;
+            }
+        }
+    }
+
+    size_t distinct() const { return used; }
+
+    // The n most frequent words, most frequent first
+    vector<pair<string_view, size_t>> top(size_t n) const {
+        vector<pair<string_view, size_t>> result;
+        for (const auto& slot : slots) {
+            if (slot.count) {
+                result.emplace_back(slot.word, slot.count);
+            }
+        }
+        n = min(n, result.size());
+        partial_sort(result.begin(), result.begin() + static_cast<long>(n), result.end(),
+                     [](const auto& a, const auto& b) { return a.second > b.second; });
+        result.resize(n);
+        return result;
+    }
+
+private:
+    struct Slot {
+        string_view word;
+        size_t hash{};
+        size_t count{};
+    };
+
+    void grow() {
+        vector<Slot> bigger(slots.size() * 2);
+        for (const auto& slot : slots) {
+            if (slot.count == 0) {
+                continue;
+            }
+            auto i = slot.hash & (bigger.size() - 1);
+            while (bigger[i].count) {
+                i = (i + 1) & (bigger.size() - 1);
+            }
+            bigger[i] = slot;
+        }
+        slots.swap(bigger);
+    }
+
+    vector<Slot> slots;
+    size_t used{};
+    WordArena arena;
+    hash<string_view> hasher;
+};
+
+// Splits [begin, end) into words and adds them; returns where the trailing partial word starts (end if none)
+const char* add_words(const char* begin, const char* end, WordFrequencies& frequencies, bool last_block) {
+    auto p = begin;
+    for (;;) {
+        while (p != end && space_table[static_cast<unsigned char>(*p)]) {
+            p++;
+        }
+        const auto word = p;
+        while (p != end && !space_table[static_cast<unsigned char>(*p)]) {
+            p++;
+        }
+        if (word == p) {
+            return end;
+        }
+        if (p == end && !last_block) {
+            return word;
+        }
+        frequencies.add(string_view{ word, static_cast<size_t>(p - word) });
+    }
+}
+
+// Usage: ccc-16 --count-words [--top N] < input
+int count_words(size_t top) {
+    const size_t block_size { 4 << 20 };
+    vector<char> buffer(block_size);
+    WordCounter counter;
+    WordFrequencies frequencies;
+    size_t carried{}, total_bytes{};
+
+    const auto start = chrono::steady_clock::now();
+    for (;;) {
+        if (carried == buffer.size()) {
+            buffer.resize(buffer.size() * 2);  // a single word longer than the buffer
+        }
+        const auto got = fread(buffer.data() + carried, 1, buffer.size() - carried, stdin);
+        const bool last_block = got == 0;
+        total_bytes += got;
+        counter.feed(buffer.data() + carried, got);
+        if (top == 0) {
+            if (last_block) {
+                break;
+            }
+            continue;
+        }
+        const auto filled = buffer.data() + carried + got;
+        const auto rest = add_words(buffer.data(), filled, frequencies, last_block);
+        carried = static_cast<size_t>(filled - rest);
+        memmove(buffer.data(), rest, carried);
+        if (last_block) {
+            break;
+        }
+    }
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    cout << "Discovered " << counter.count() << " words.\n";
+    if (top > 0) {
+        cout << frequencies.distinct() << " distinct words, most frequent:\n";
+        for (const auto& [word, count] : frequencies.top(top)) {
+            cout << "  " << count << "  " << word << "\n";
+        }
+    }
+    cerr << total_bytes / 1e9 / elapsed.count() << " GB/s\n";
+    return ferror(stdin) ? 1 : 0;
+}
+
+// Usage: ccc-16 --numbers N   writes N random numbers both ways, then reads them back both ways
+void benchmark_numbers(size_t n) {
+    const char* path { "numbers_benchmark.txt" };
+    mt19937_64 rng{ 1 };
+    vector<long long> values(n);
+    for (auto& value : values) {
+        value = static_cast<long long>(rng() % 2'000'000'001) - 1'000'000'000;
+    }
+    auto seconds = [](auto start) { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+
+    auto start = chrono::steady_clock::now();
+    {
+        ofstream out{ path };
+        for (auto value : values) {
+            out << value << endl;
+        }
+    }
+    cout << "ofstream << endl:         " << seconds(start) << " s\n";
+
+    start = chrono::steady_clock::now();
+    {
+        NumberWriter out{ path };
+        out.write(values);
+    }
+    cout << "NumberWriter:             " << seconds(start) << " s\n";
+
+    start = chrono::steady_clock::now();
+    ifstream in{ path };
+    auto max_num = numeric_limits<long long>::min();
+    long long value;
+    while (in >> value) {
+        max_num = max_num < value ? value : max_num;
+    }
+    cout << "ifstream >> value:        " << seconds(start) << " s (max " << max_num << ")\n";
+
+    for (size_t threads : { size_t{ 1 }, size_t{ 0 } }) {
+        start = chrono::steady_clock::now();
+        const auto stats = summarize_numbers_file(path, threads);
+        cout << "summarize_numbers_file(" << threads << "): " << seconds(start) << " s (max " << stats.max
+             << ", min " << stats.min << ", sum " << stats.sum << ", count " << stats.count << ")\n";
+    }
+    remove(path);
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && string{ argv[1] } == "--numbers") {
+        benchmark_numbers(stoull(argv[2]));
+        return 0;
+    }
+    if (argc >= 2 && string{ argv[1] } == "--count-words") {
+        return count_words(argc == 4 && string{ argv[2] } == "--top" ? stoull(argv[3]) : 0);
+    }
+
     // basic cout example
     bitset<8> s{ "01110011" };
     string str("Crying zeros and I'm hearing ");
@@ -143,4 +626,8 @@ int main() {
   }
 
   cout << "Max number in file is " << max_num << endl;
+
+  // Same file through the block reader, with every reduction in one pass
+  const auto stats = summarize_numbers_file("numbers.txt");
+  cout << "Max " << stats.max << ", min " << stats.min << ", sum " << stats.sum << " over " << stats.count << " numbers" << endl;
 }
\ No newline at end of file
@@ -1,8 +1,30 @@
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 #include <filesystem>
 #include <string>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 TEST_CASE("std::filesystem::path supports == and .empty()") {
     std::filesystem::path empty_path;
@@ -63,4 +85,508 @@ TEST_CASE("C++ offers means of iterating through directory") {
     );
 
     REQUIRE(file_count == 4);
+}
+
+/*
+    Parallel recursive directory scanner: directory_iterator lists one directory at a time on one thread and a
+    follow-up status() costs a full stat per entry. On network filesystems every one of those is a round trip.
+        - Subdirectories are fanned out to a pool of worker threads through a shared queue, so many directories
+          are being listed at once and the latency overlaps.
+        - On Linux, directories are read with getdents64 in 64 KiB batches; the entry type comes for free from
+          d_type. statx is only called when Size or MTime is requested (or the filesystem doesn't fill d_type),
+          asking only for those fields, relative to the open directory fd and with AT_STATX_DONT_SYNC so network
+          filesystems may answer from their attribute cache. Elsewhere it falls back to std::filesystem.
+        - Results are streamed to a callback as they are found (from the worker threads, so it must be thread-safe);
+          nothing is collected into a vector. ScanEntry points into the scanner's buffers, copy what you keep.
+        - Symlinks are reported, not followed (like recursive_directory_iterator's default).
+        - Optional on-disk cache keyed by directory mtime: a directory whose mtime hasn't changed since the cached
+          scan is replayed from the cache without listing it - one statx instead of a getdents + statx per entry.
+          Subdirectories are still visited (a deeper change doesn't touch the parent's mtime). Editing a file in
+          place doesn't change its directory's mtime either, so cached Size/MTime values can be stale.
+*/
+enum class EntryType : uint8_t { Unknown, File, Directory, Symlink, Other };
+
+enum ScanFields : unsigned {
+    TypeOnly = 0,
+    Size = 1,
+    MTime = 2
+};
+
+struct ScanEntry {
+    std::string_view directory;
+    std::string_view name;
+    EntryType type;
+    uint64_t size;      // only with ScanFields::Size
+    int64_t mtime_ns;   // only with ScanFields::MTime
+};
+
+struct ScanStats {
+    size_t directories{};
+    size_t entries{};
+    size_t errors{};
+    size_t cached_directories{};
+};
+
+class DirectoryScanner {
+public:
+    using Callback = std::function<void(const ScanEntry&)>;
+
+    explicit DirectoryScanner(size_t threads = std::max(1u, std::thread::hardware_concurrency()),
+                              std::filesystem::path cache_path = {})
+        : threads{ std::max<size_t>(1, threads) }, cache_path{ std::move(cache_path) } {
+        load_cache();
+    }
+
+    ScanStats scan(const std::filesystem::path& root, unsigned fields, const Callback& callback) {
+        ScanStats stats;
+        std::mutex lock;
+        std::condition_variable changed;
+        std::deque<std::string> queue{ root.string() };
+        size_t pending { 1 };
+        std::unordered_map<std::string, CachedDirectory> next_cache;
+
+        auto worker = [&] {
+            ScanStats mine;
+            std::unique_lock<std::mutex> guard{ lock };
+            for (;;) {
+                changed.wait(guard, [&] { return !queue.empty() || pending == 0; });
+                if (queue.empty()) {
+                    break;
+                }
+                auto directory = std::move(queue.front());
+                queue.pop_front();
+                guard.unlock();
+
+                std::vector<std::string> subdirectories;
+                CachedDirectory listing;
+                scan_directory(directory, fields, callback, subdirectories, listing, mine);
+
+                guard.lock();
+                if (!cache_path.empty() && listing.mtime_ns != 0) {
+                    next_cache[directory] = std::move(listing);
+                }
+                for (auto& subdirectory : subdirectories) {
+                    queue.push_back(std::move(subdirectory));
+                }
+                pending += subdirectories.size();
+                pending--;
+                if (!subdirectories.empty() || pending == 0) {
+                    changed.notify_all();
+                }
+            }
+            stats.directories += mine.directories;
+            stats.entries += mine.entries;
+            stats.errors += mine.errors;
+            stats.cached_directories += mine.cached_directories;
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t i { 1 }; i < threads; i++) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : pool) {
+            thread.join();
+        }
+
+        if (!cache_path.empty()) {
+            // Directories outside this root stay cached for other scans
+            for (auto& [directory, listing] : next_cache) {
+                cache[directory] = std::move(listing);
+            }
+            save_cache();
+        }
+        return stats;
+    }
+
+private:
+    struct CachedEntry {
+        std::string name;
+        EntryType type;
+        uint64_t size;
+        int64_t mtime_ns;
+    };
+    struct CachedDirectory {
+        int64_t mtime_ns{};
+        unsigned fields{};
+        std::vector<CachedEntry> entries;
+    };
+
+    void scan_directory(const std::string& directory, unsigned fields, const Callback& callback,
+                        std::vector<std::string>& subdirectories, CachedDirectory& listing, ScanStats& stats) {
+        auto report = [&](std::string_view name, EntryType type, uint64_t size, int64_t mtime_ns) {
+            callback(ScanEntry{ directory, name, type, size, mtime_ns });
+            stats.entries++;
+            if (type == EntryType::Directory) {
+                subdirectories.push_back(join(directory, name));
+            }
+            if (!cache_path.empty()) {
+                listing.entries.push_back(CachedEntry{ std::string{ name }, type, size, mtime_ns });
+            }
+        };
+
+        const bool caching = !cache_path.empty();
+        if (caching) {
+            listing.mtime_ns = directory_mtime(directory);
+            listing.fields = fields;
+            const auto cached = cache.find(directory);
+            if (listing.mtime_ns != 0 && cached != cache.end() && cached->second.mtime_ns == listing.mtime_ns &&
+                (cached->second.fields & fields) == fields) {
+                listing.fields = cached->second.fields;
+                for (const auto& entry : cached->second.entries) {
+                    report(entry.name, entry.type, entry.size, entry.mtime_ns);
+                }
+                stats.directories++;
+                stats.cached_directories++;
+                return;
+            }
+        }
+
+#if defined(__linux__) && defined(STATX_TYPE)
+        const auto fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            stats.errors++;
+            listing.mtime_ns = 0;
+            return;
+        }
+        stats.directories++;
+        alignas(8) char buffer[64 * 1024];
+        for (;;) {
+            const auto got = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+            if (got <= 0) {
+                if (got < 0) {
+                    stats.errors++;
+                    listing.mtime_ns = 0;  // incomplete listing: don't cache it
+                }
+                break;
+            }
+            for (long offset{}; offset < got; ) {
+                // struct linux_dirent64 { ino64_t d_ino; off64_t d_off; unsigned short d_reclen; unsigned char d_type; char d_name[]; }
+                const auto record = buffer + offset;
+                unsigned short length;
+                std::memcpy(&length, record + 16, sizeof(length));
+                const auto d_type = static_cast<unsigned char>(record[18]);
+                const std::string_view name{ record + 19 };
+                offset += length;
+                if (name == "." || name == "..") {
+                    continue;
+                }
+
+                auto type = from_d_type(d_type);
+                uint64_t size{};
+                int64_t mtime_ns{};
+                unsigned mask{};
+                if (type == EntryType::Unknown) mask |= STATX_TYPE;
+                if (fields & ScanFields::Size) mask |= STATX_SIZE;
+                if (fields & ScanFields::MTime) mask |= STATX_MTIME;
+                if (mask) {
+                    struct statx info;
+                    if (statx(fd, record + 19, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, mask, &info) == 0) {
+                        if (type == EntryType::Unknown) type = from_mode(info.stx_mode);
+                        size = info.stx_size;
+                        mtime_ns = info.stx_mtime.tv_sec * 1'000'000'000LL + info.stx_mtime.tv_nsec;
+                    } else {
+                        stats.errors++;
+                    }
+                }
+                report(name, type, size, mtime_ns);
+            }
+        }
+        close(fd);
+#else
+        std::error_code error;
+        std::filesystem::directory_iterator entries{ directory, error };
+        if (error) {
+            stats.errors++;
+            listing.mtime_ns = 0;
+            return;
+        }
+        stats.directories++;
+        for (const auto& entry : entries) {
+            const auto status = entry.symlink_status(error);
+            auto type = EntryType::Other;
+            if (std::filesystem::is_regular_file(status)) type = EntryType::File;
+            else if (std::filesystem::is_directory(status)) type = EntryType::Directory;
+            else if (std::filesystem::is_symlink(status)) type = EntryType::Symlink;
+            uint64_t size{};
+            int64_t mtime_ns{};
+            if ((fields & ScanFields::Size) && type == EntryType::File) size = entry.file_size(error);
+            if (fields & ScanFields::MTime) {
+                mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    entry.last_write_time(error).time_since_epoch()).count();
+            }
+            const auto name = entry.path().filename().string();
+            report(name, type, size, mtime_ns);
+        }
+#endif
+    }
+
+    static std::string join(const std::string& directory, std::string_view name) {
+        std::string path;
+        path.reserve(directory.size() + 1 + name.size());
+        path += directory;
+        if (!path.empty() && path.back() != '/') {
+            path += '/';
+        }
+        path += name;
+        return path;
+    }
+
+    static int64_t directory_mtime(const std::string& directory) {
+        std::error_code error;
+        const auto time = std::filesystem::last_write_time(directory, error);
+        return error ? 0 : std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+#if defined(__linux__) && defined(STATX_TYPE)
+    static EntryType from_d_type(unsigned char d_type) {
+        switch (d_type) {
+            case DT_REG: return EntryType::File;
+            case DT_DIR: return EntryType::Directory;
+            case DT_LNK: return EntryType::Symlink;
+            case DT_UNKNOWN: return EntryType::Unknown;
+            default: return EntryType::Other;
+        }
+    }
+    static EntryType from_mode(unsigned mode) {
+        if (S_ISREG(mode)) return EntryType::File;
+        if (S_ISDIR(mode)) return EntryType::Directory;
+        if (S_ISLNK(mode)) return EntryType::Symlink;
+        return EntryType::Other;
+    }
+#endif
+
+    /*
+        Cache file: "CCCSCAN1", then per directory:
+            u32 path length, path, i64 mtime_ns, u32 fields, u32 entry count,
+            per entry: u32 name length, name, u8 type, u64 size, i64 mtime_ns
+        A truncated or foreign file is ignored.
+    */
+    static constexpr char cache_magic[8] = { 'C', 'C', 'C', 'S', 'C', 'A', 'N', '1' };
+
+    void load_cache() {
+        if (cache_path.empty()) {
+            return;
+        }
+        std::ifstream in{ cache_path, std::ios::binary };
+        char magic[8]{};
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, cache_magic, sizeof(magic)) != 0) {
+            return;
+        }
+        auto read_string = [&](std::string& text) {
+            uint32_t length{};
+            if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) return false;
+            text.resize(length);
+            return static_cast<bool>(in.read(text.data(), length));
+        };
+        auto read_value = [&](auto& value) { return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value))); };
+        std::string directory;
+        while (read_string(directory)) {
+            CachedDirectory listing;
+            uint32_t count{};
+            if (!read_value(listing.mtime_ns) || !read_value(listing.fields) || !read_value(count)) {
+                cache.clear();
+                return;
+            }
+            listing.entries.resize(count);
+            for (auto& entry : listing.entries) {
+                if (!read_string(entry.name) || !read_value(entry.type) || !read_value(entry.size) || !read_value(entry.mtime_ns)) {
+                    cache.clear();
+                    return;
+                }
+            }
+            cache[directory] = std::move(listing);
+        }
+    }
+
+    void save_cache() const {
+        // Write to a temporary file and rename, so a crash never leaves a half-written cache behind
+        auto temporary = cache_path;
+        temporary += ".tmp";
+        {
+            std::ofstream out{ temporary, std::ios::binary | std::ios::trunc };
+            out.write(cache_magic, sizeof(cache_magic));
+            auto write_string = [&](std::string_view text) {
+                const auto length = static_cast<uint32_t>(text.size());
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                out.write(text.data(), length);
+            };
+            auto write_value = [&](const auto& value) { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+            for (const auto& [directory, listing] : cache) {
+                write_string(directory);
+                write_value(listing.mtime_ns);
+                write_value(listing.fields);
+                write_value(static_cast<uint32_t>(listing.entries.size()));
+                for (const auto& entry : listing.entries) {
+                    write_string(entry.name);
+                    write_value(entry.type);
+                    write_value(entry.size);
+                    write_value(entry.mtime_ns);
+                }
+            }
+            if (!out) {
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, cache_path, error);
+    }
+
+    size_t threads;
+    std::filesystem::path cache_path;
+    std::unordered_map<std::string, CachedDirectory> cache;
+};
+
+// Builds a small tree under the temp directory and removes it again
+struct ScratchTree {
+    ScratchTree() : root{ std::filesystem::temp_directory_path() / ("ccc17-scan-" + std::to_string(::getpid())) } {
+        std::filesystem::remove_all(root);
+        for (int d{}; d < 5; d++) {
+            const auto directory = root / ("dir" + std::to_string(d)) / "nested";
+            std::filesystem::create_directories(directory);
+            for (int f{}; f < 20; f++) {
+                std::ofstream{ directory / ("file" + std::to_string(f) + ".txt") } << std::string(static_cast<size_t>(f), 'x');
+            }
+        }
+        std::ofstream{ root / "top.txt" } << "top";
+    }
+    ~ScratchTree() { std::filesystem::remove_all(root); }
+    std::filesystem::path root;
+};
+
+std::set<std::string> scanned_paths(DirectoryScanner& scanner, const std::filesystem::path& root, ScanStats* stats = nullptr) {
+    std::mutex lock;
+    std::set<std::string> paths;
+    const auto result = scanner.scan(root, ScanFields::Size, [&](const ScanEntry& entry) {
+        std::lock_guard<std::mutex> guard{ lock };
+        const auto size = entry.type == EntryType::File ? entry.size : 0;  // directories report their block size
+        paths.insert(std::string{ entry.directory } + "/" + std::string{ entry.name } + ":" + std::to_string(size));
+    });
+    if (stats) {
+        *stats = result;
+    }
+    return paths;
+}
+
+TEST_CASE("DirectoryScanner") {
+    ScratchTree tree;
+    std::set<std::string> expected;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator{ tree.root }) {
+        const auto size = entry.is_regular_file() ? entry.file_size() : 0;
+        expected.insert(entry.path().parent_path().string() + "/" + entry.path().filename().string() + ":" + std::to_string(size));
+    }
+
+    SECTION("finds the same entries as recursive_directory_iterator, with sizes") {
+        for (size_t threads : { 1, 4 }) {
+            DirectoryScanner scanner{ threads };
+            ScanStats stats;
+            REQUIRE(scanned_paths(scanner, tree.root, &stats) == expected);
+            REQUIRE(stats.entries == expected.size());
+            REQUIRE(stats.directories == 11);
+            REQUIRE(stats.errors == 0);
+        }
+    }
+
+    SECTION("replays unchanged directories from the cache and rescans changed ones") {
+        const auto cache_file = tree.root.string() + ".cache";
+        {
+            DirectoryScanner scanner{ 2, cache_file };
+            ScanStats stats;
+            REQUIRE(scanned_paths(scanner, tree.root, &stats) == expected);
+            REQUIRE(stats.cached_directories == 0);
+        }
+        std::ofstream{ tree.root / "dir3" / "new.txt" } << "new!";
+        expected.insert((tree.root / "dir3").string() + "/new.txt:4");
+        {
+            DirectoryScanner scanner{ 2, cache_file };  // loads what the first scanner saved
+            ScanStats stats;
+            REQUIRE(scanned_paths(scanner, tree.root, &stats) == expected);
+            REQUIRE(stats.cached_directories == 10);
+        }
+        std::filesystem::remove(cache_file);
+    }
+
+    SECTION("reports unreadable roots as errors") {
+        DirectoryScanner scanner{ 2 };
+        ScanStats stats;
+        REQUIRE(scanned_paths(scanner, tree.root / "missing", &stats).empty());
+        REQUIRE(stats.errors == 1);
+    }
+}
+
+// Hidden by the leading dot; run with: ./ccc-17 "[.benchmark]" (scans /usr)
+TEST_CASE("DirectoryScanner vs recursive_directory_iterator", "[.benchmark]") {
+    const std::filesystem::path root { "/usr" };
+    auto seconds_since = [](auto start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // untimed warm-up, so every contender sees the same (hot) dentry and inode caches
+    DirectoryScanner{}.scan(root, ScanFields::Size, [](const ScanEntry&) { });
+
+    auto start = std::chrono::steady_clock::now();
+    size_t iterated{};
+    uint64_t iterated_bytes{};
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator{ root, std::filesystem::directory_options::skip_permission_denied, error };
+         it != std::filesystem::recursive_directory_iterator{}; it.increment(error)) {
+        iterated++;
+        if (it->is_regular_file(error) && !it->is_symlink(error)) {
+            iterated_bytes += it->file_size(error);
+        }
+    }
+    const auto iterator_seconds = seconds_since(start);
+
+    for (size_t threads : { size_t{ 1 }, size_t{ 8 } }) {
+        DirectoryScanner scanner{ threads };
+        std::atomic<size_t> scanned{};
+        std::atomic<uint64_t> scanned_bytes{};
+        start = std::chrono::steady_clock::now();
+        scanner.scan(root, ScanFields::Size, [&](const ScanEntry& entry) {
+            scanned.fetch_add(1, std::memory_order_relaxed);
+            if (entry.type == EntryType::File) {
+                scanned_bytes.fetch_add(entry.size, std::memory_order_relaxed);
+            }
+        });
+        const auto scanner_seconds = seconds_since(start);
+        printf("DirectoryScanner, %zu threads: %zu entries, %llu bytes, %.3f s\n", threads, scanned.load(),
+               static_cast<unsigned long long>(scanned_bytes.load()), scanner_seconds);
+    }
+    // the byte totals are a cross-check that both walks saw the same files (they can drift if /usr changes meanwhile)
+    printf("recursive_directory_iterator: %zu entries, %llu bytes, %.3f s\n", iterated,
+           static_cast<unsigned long long>(iterated_bytes), iterator_seconds);
+}
+
+/*
+    Micro-benchmarks for path handling and directory walks over a small scratch tree (106 entries), hidden by
+    [!benchmark]. Machine-readable results: ./ccc-17 "[!benchmark]" -r xml -o ccc-17-benchmarks.xml
+*/
+TEST_CASE("Filesystem benchmarks", "[!benchmark]") {
+    const std::filesystem::path kernel32{ R"(C:\Windows\System32\kernel32.dll)" };
+    BENCHMARK("path construct + filename()") { return std::filesystem::path{ "/usr/include/c++/12/vector" }.filename(); };
+    BENCHMARK("path / composition") { return std::filesystem::path{ "/usr" } / "include" / "c++" / "vector"; };
+    BENCHMARK("path replace_extension") {
+        auto copy = kernel32;
+        return copy.replace_extension(".bak");
+    };
+
+    ScratchTree tree;
+    BENCHMARK("recursive_directory_iterator") {
+        size_t entries{};
+        for (const auto& entry : std::filesystem::recursive_directory_iterator{ tree.root }) {
+            entries += entry.is_regular_file();
+        }
+        return entries;
+    };
+    DirectoryScanner scanner{ 1 };
+    BENCHMARK("DirectoryScanner, 1 thread, TypeOnly") {
+        std::atomic<size_t> entries{};
+        scanner.scan(tree.root, ScanFields::TypeOnly, [&](const ScanEntry&) { entries++; });
+        return entries.load();
+    };
+    BENCHMARK("DirectoryScanner, 1 thread, Size") {
+        std::atomic<size_t> entries{};
+        scanner.scan(tree.root, ScanFields::Size, [&](const ScanEntry&) { entries++; });
+        return entries.load();
+    };
 }
\ No newline at end of file
@@ -9,9 +9,25 @@
         - requires -pthread compiler option to compile
 */
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 #include <future>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <chrono>
+#include <cstdio>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace std;
 
@@ -48,4 +64,405 @@ TEST_CASE("Waiting for a task to complete") {
     REQUIRE(not_ready_yet == future_status::timeout);
     const auto ready_now = sleepy.wait_for(100ms);
     REQUIRE(ready_now == future_status::ready);
+}
+
+/*
+    Work-stealing thread pool: async(launch::async, ...) starts a brand new OS thread for every task, which costs
+    tens of microseconds - more than most of the tasks we run. The pool starts its workers once and reuses them.
+        - Every worker owns a Chase-Lev deque (Le, Pop, Cohen, Zappa Nardelli, "Correct and Efficient Work-Stealing
+          for Weak Memory Models"). The owner pushes and pops at the bottom without locks; idle workers steal from
+          the top with one compare-and-swap.
+        - Tasks submitted from outside the pool go into a shared injection queue; tasks submitted from inside a task
+          go onto the current worker's own deque, so nested work stays cache-hot and others steal it when idle.
+        - submit() returns an ordinary std::future (built from a packaged_task), so valid(), get(), wait_for() and
+          exception propagation behave exactly like they do with async.
+        - Workers sleep on a condition variable when there is nothing to run, and can optionally be pinned to cores.
+*/
+class ChaseLevDeque {
+public:
+    using Item = function<void()>*;
+
+    explicit ChaseLevDeque(size_t capacity = 64) : array{ new Array{ capacity } } { }
+    ~ChaseLevDeque() {
+        delete array.load(memory_order_relaxed);
+        for (auto old : retired) {
+            delete old;
+        }
+    }
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // Owner only
+    void push(Item item) {
+        const auto b = bottom.load(memory_order_relaxed);
+        const auto t = top.load(memory_order_acquire);
+        auto a = array.load(memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->capacity) - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, item);
+        atomic_thread_fence(memory_order_release);
+        bottom.store(b + 1, memory_order_relaxed);
+    }
+
+    // Owner only: newest item first (LIFO keeps the owner on the work it just created)
+    Item pop() {
+        const auto b = bottom.load(memory_order_relaxed) - 1;
+        const auto a = array.load(memory_order_relaxed);
+        bottom.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        auto t = top.load(memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, memory_order_relaxed);
+            return nullptr;
+        }
+        auto item = a->get(b);
+        if (t == b) {
+            // Last item: race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom.store(b + 1, memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread: oldest item first. Returns nullptr if empty or if another thief won the race.
+    Item steal() {
+        auto t = top.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        const auto b = bottom.load(memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        const auto item = array.load(memory_order_acquire)->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    struct Array {
+        explicit Array(size_t capacity) : capacity{ capacity }, mask{ capacity - 1 }, slots{ new atomic<Item>[capacity] } { }
+        ~Array() { delete[] slots; }
+        Item get(int64_t i) const { return slots[i & mask].load(memory_order_relaxed); }
+        void put(int64_t i, Item item) { slots[i & mask].store(item, memory_order_relaxed); }
+        const size_t capacity, mask;
+        atomic<Item>* slots;
+    };
+
+    // Thieves may still be reading the old array, so it is kept alive until the deque dies
+    Array* grow(Array* old, int64_t t, int64_t b) {
+        auto bigger = new Array{ old->capacity * 2 };
+        for (auto i = t; i < b; i++) {
+            bigger->put(i, old->get(i));
+        }
+        retired.push_back(old);
+        array.store(bigger, memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) atomic<int64_t> top{};
+    alignas(64) atomic<int64_t> bottom{};
+    atomic<Array*> array;
+    vector<Array*> retired;
+};
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads = max(1u, thread::hardware_concurrency()), bool pin_to_cores = false) {
+        if (threads == 0) {
+            threads = 1;
+        }
+        for (size_t i{}; i < threads; i++) {
+            queues.push_back(make_unique<ChaseLevDeque>());
+        }
+        for (size_t i{}; i < threads; i++) {
+            workers.emplace_back([this, i] { run(i); });
+            if (pin_to_cores) {
+                pin(workers.back(), i);
+            }
+        }
+    }
+
+    // Runs every task that was already submitted, then joins the workers
+    ~WorkStealingPool() {
+        stopping.store(true);
+        {
+            lock_guard<mutex> guard{ sleep_lock };
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    template <typename Fn, typename... Args>
+    auto submit(Fn&& fn, Args&&... args) -> future<invoke_result_t<decay_t<Fn>, decay_t<Args>...>> {
+        using Result = invoke_result_t<decay_t<Fn>, decay_t<Args>...>;
+        auto task = make_shared<packaged_task<Result()>>(
+            [fn = forward<Fn>(fn), ...args = forward<Args>(args)]() mutable { return invoke(move(fn), move(args)...); });
+        auto result = task->get_future();
+        enqueue(new function<void()>{ [task = move(task)] { (*task)(); } });
+        return result;
+    }
+
+    size_t size() const { return workers.size(); }
+
+private:
+    using Item = ChaseLevDeque::Item;
+
+    void enqueue(Item item) {
+        if (current_pool == this) {
+            queues[current_worker]->push(item);
+        } else {
+            lock_guard<mutex> guard{ injection_lock };
+            injection.push_back(item);
+        }
+        // Paired with the sleepers++ / queued check in run(): one of the two sides always sees the other
+        queued.fetch_add(1);
+        if (sleepers.load() > 0) {
+            {
+                lock_guard<mutex> guard{ sleep_lock };
+            }
+            wake.notify_one();
+        }
+    }
+
+    Item find_work(size_t self) {
+        if (auto item = queues[self]->pop()) {
+            return item;
+        }
+        {
+            lock_guard<mutex> guard{ injection_lock };
+            if (!injection.empty()) {
+                auto item = injection.front();
+                injection.pop_front();
+                return item;
+            }
+        }
+        for (size_t i { 1 }; i < queues.size(); i++) {
+            if (auto item = queues[(self + i) % queues.size()]->steal()) {
+                return item;
+            }
+        }
+        return nullptr;
+    }
+
+    void run(size_t self) {
+        current_pool = this;
+        current_worker = self;
+        for (;;) {
+            if (auto item = find_work(self)) {
+                queued.fetch_sub(1);
+                (*item)();
+                delete item;
+                continue;
+            }
+            if (queued.load() > 0) {
+                // Someone else is between taking an item and decrementing, or lost a steal race
+                this_thread::yield();
+                continue;
+            }
+            unique_lock<mutex> lock{ sleep_lock };
+            sleepers.fetch_add(1);
+            wake.wait(lock, [&] { return queued.load() > 0 || stopping.load(); });
+            sleepers.fetch_sub(1);
+            if (stopping.load() && queued.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    static void pin(thread& worker, size_t index) {
+#if defined(__linux__)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(index % max(1u, thread::hardware_concurrency()), &cpus);
+        pthread_setaffinity_np(worker.native_handle(), sizeof(cpus), &cpus);
+#else
+        (void)worker;
+        (void)index;
+#endif
+    }
+
+    vector<unique_ptr<ChaseLevDeque>> queues;
+    vector<thread> workers;
+    mutex injection_lock;
+    deque<Item> injection;
+    mutex sleep_lock;
+    condition_variable wake;
+    atomic<size_t> queued{};
+    atomic<size_t> sleepers{};
+    atomic<bool> stopping{};
+
+    static thread_local WorkStealingPool* current_pool;
+    static thread_local size_t current_worker;
+};
+
+thread_local WorkStealingPool* WorkStealingPool::current_pool{};
+thread_local size_t WorkStealingPool::current_worker{};
+
+// The async tests above, against the pool
+TEST_CASE("WorkStealingPool") {
+    WorkStealingPool pool{ 4 };
+
+    SECTION("valid() ensures that result is obtainable from future") {
+        using namespace literals::string_literals;
+        auto the_future = pool.submit([] { return "female"s; });
+        REQUIRE(the_future.valid());
+        auto result = the_future.get();
+        REQUIRE(result == "female");
+        REQUIRE_FALSE(the_future.valid());
+    }
+
+    SECTION("valid() is false once the future has been moved from") {
+        auto the_future = pool.submit([] { return true; });
+        auto moved = move(the_future);
+        REQUIRE_FALSE(the_future.valid());
+        REQUIRE(moved.get());
+    }
+
+    SECTION("future will throw any errors the task throws") {
+        auto explosion = pool.submit([] { throw runtime_error { "Boom." }; });
+        REQUIRE_THROWS_AS(explosion.get(), runtime_error);
+    }
+
+    SECTION("waiting for a task to complete") {
+        using namespace literals::chrono_literals;
+        auto sleepy = pool.submit([] { this_thread::sleep_for(100ms); });
+        const auto not_ready_yet = sleepy.wait_for(25ms);
+        REQUIRE(not_ready_yet == future_status::timeout);
+        const auto ready_now = sleepy.wait_for(100ms);
+        REQUIRE(ready_now == future_status::ready);
+    }
+
+    SECTION("arguments are passed through") {
+        auto sum = pool.submit([](int a, int b) { return a + b; }, 40, 2);
+        REQUIRE(sum.get() == 42);
+    }
+
+    SECTION("tasks submitted from a task land on the worker's deque and all run") {
+        atomic<int> ran{};
+        auto parent = pool.submit([&] {
+            vector<future<void>> children;
+            for (int i{}; i < 1000; i++) {
+                children.push_back(pool.submit([&] { ran++; }));
+            }
+            return children;
+        });
+        for (auto& child : parent.get()) {
+            child.get();
+        }
+        REQUIRE(ran == 1000);
+    }
+}
+
+TEST_CASE("WorkStealingPool runs every submitted task before it is destroyed") {
+    atomic<int> ran{};
+    {
+        WorkStealingPool pool{ 2 };
+        for (int i{}; i < 10'000; i++) {
+            pool.submit([&] { ran++; });
+        }
+    }
+    REQUIRE(ran == 10'000);
+}
+
+TEST_CASE("ChaseLevDeque grows and hands every item out exactly once") {
+    ChaseLevDeque deque{ 2 };
+    vector<function<void()>> items(1000);
+    for (auto& item : items) {
+        deque.push(&item);
+    }
+    // thieves take the oldest items, the owner the newest
+    for (size_t i{}; i < 500; i++) {
+        REQUIRE(deque.steal() == &items[i]);
+    }
+    for (size_t i { items.size() }; i > 500; i--) {
+        REQUIRE(deque.pop() == &items[i - 1]);
+    }
+    REQUIRE(deque.pop() == nullptr);
+    REQUIRE(deque.steal() == nullptr);
+}
+
+// Spawn overhead per task: a fresh thread per task with async vs. reusing the pool's workers.
+// Hidden by the leading dot; run with: ./ccc-19 "[.benchmark]"
+TEST_CASE("Spawn overhead per task", "[.benchmark]") {
+    const size_t tasks { 20'000 };
+    auto time_per_task = [&](auto&& spawn_all) {
+        const auto start = chrono::steady_clock::now();
+        spawn_all();
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / tasks;
+    };
+
+    const auto async_ns = time_per_task([&] {
+        for (size_t i{}; i < tasks; i++) {
+            async(launch::async, [] { return 1; }).get();
+        }
+    });
+    WorkStealingPool pool;
+    const auto pool_ns = time_per_task([&] {
+        for (size_t i{}; i < tasks; i++) {
+            pool.submit([] { return 1; }).get();
+        }
+    });
+    const auto pool_batch_ns = time_per_task([&] {
+        vector<future<int>> results;
+        results.reserve(tasks);
+        for (size_t i{}; i < tasks; i++) {
+            results.push_back(pool.submit([] { return 1; }));
+        }
+        for (auto& result : results) {
+            result.get();
+        }
+    });
+    printf("async(launch::async) round trip: %9.0f ns/task\n", async_ns);
+    printf("pool.submit round trip:          %9.0f ns/task\n", pool_ns);
+    printf("pool.submit, %zu in flight:    %9.0f ns/task\n", tasks, pool_batch_ns);
+}
+
+/*
+    Micro-benchmarks for the ways of getting a result from another task, from a plain mutex up to std::async with a
+    fresh thread per call. Hidden by [!benchmark]; the XML reporter gives machine-readable results:
+        ./ccc-19 "[!benchmark]" -r xml -o ccc-19-benchmarks.xml
+*/
+TEST_CASE("Async benchmarks", "[!benchmark]") {
+    atomic<long long> counter{};
+    mutex lock;
+    long long guarded{};
+    BENCHMARK("atomic fetch_add") { return counter.fetch_add(1, memory_order_relaxed); };
+    BENCHMARK("mutex lock + unlock") {
+        lock_guard<mutex> guard{ lock };
+        return ++guarded;
+    };
+    BENCHMARK("promise + future, same thread") {
+        promise<int> result;
+        auto value = result.get_future();
+        result.set_value(42);
+        return value.get();
+    };
+    BENCHMARK("packaged_task invoke + get") {
+        packaged_task<int()> task{ [] { return 42; } };
+        auto value = task.get_future();
+        task();
+        return value.get();
+    };
+    BENCHMARK("async(launch::deferred) + get") { return async(launch::deferred, [] { return 42; }).get(); };
+    BENCHMARK("async(launch::async) + get (new thread)") { return async(launch::async, [] { return 42; }).get(); };
+
+    WorkStealingPool pool;
+    BENCHMARK("WorkStealingPool submit + get") { return pool.submit([] { return 42; }).get(); };
+    BENCHMARK("WorkStealingPool 1000 submits, then get") {
+        vector<future<int>> results;
+        results.reserve(1000);
+        for (int i{}; i < 1000; i++) results.push_back(pool.submit([i] { return i; }));
+        long long sum{};
+        for (auto& result : results) sum += result.get();
+        return sum;
+    };
 }
\ No newline at end of file
@@ -24,6 +24,14 @@
 #include <atomic>
 #include <condition_variable>
 #include <iostream>
+#include <queue>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
 
 using namespace std;
 
@@ -154,22 +162,636 @@ void conditional_rodeo() {
     cout << "Tin cans available: " << tin_cans_available << endl;
 }
 
-int main() {
-    goat_rodeo();
-    goat_rodeo();
-    goat_rodeo();
+/*
+    Bounded MPMC ring buffer (Dmitry Vyukov's design): a power-of-two array of cells, each with a sequence number
+    that says whose turn the cell is.
+        - cell.sequence == pos      -> empty, free for the producer that claims position pos
+        - cell.sequence == pos + 1  -> full, ready for the consumer that claims position pos
+        - After popping, the consumer sets it to pos + capacity: free for the producer one lap later.
+    Producers and consumers each claim positions with a CAS on their own counter (on separate cache lines), so
+    there are no locks and producers don't contend with consumers. try_push_n / try_pop_n claim a run of
+    ready cells with a single CAS, which amortizes the contended part over a whole batch.
+*/
+template <typename T>
+class MpmcRing {
+public:
+    explicit MpmcRing(size_t capacity) : mask{ round_up(capacity) - 1 }, cells{ new Cell[mask + 1] } {
+        for (size_t i{}; i <= mask; i++) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+    ~MpmcRing() { delete[] cells; }
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    bool try_push(const T& value) { return try_push_n(&value, 1) == 1; }
+    bool try_pop(T& value) { return try_pop_n(&value, 1) == 1; }
+
+    // Pushes up to n values, returns how many made it (0 when full)
+    size_t try_push_n(const T* values, size_t n) {
+        if (n == 0) {
+            return 0;  // otherwise count_ready finds nothing and the loop mistakes that for contention
+        }
+        auto pos = enqueue_pos.load(memory_order_relaxed);
+        for (;;) {
+            const auto ready = count_ready(pos, n, 0);
+            if (ready == 0) {
+                const auto seq = cells[pos & mask].sequence.load(memory_order_acquire);
+                if (static_cast<intptr_t>(seq - pos) < 0) {
+                    return 0;  // a full lap behind: the queue is full
+                }
+                pos = enqueue_pos.load(memory_order_relaxed);
+                continue;
+            }
+            if (enqueue_pos.compare_exchange_weak(pos, pos + ready, memory_order_relaxed)) {
+                for (size_t i{}; i < ready; i++) {
+                    auto& cell = cells[(pos + i) & mask];
+                    cell.value = values[i];
+                    cell.sequence.store(pos + i + 1, memory_order_release);
+                }
+                return ready;
+            }
+        }
+    }
+
+    // Pops up to n values, returns how many it got (0 when empty)
+    size_t try_pop_n(T* values, size_t n) {
+        if (n == 0) {
+            return 0;
+        }
+        auto pos = dequeue_pos.load(memory_order_relaxed);
+        for (;;) {
+            const auto ready = count_ready(pos, n, 1);
+            if (ready == 0) {
+                const auto seq = cells[pos & mask].sequence.load(memory_order_acquire);
+                if (static_cast<intptr_t>(seq - (pos + 1)) < 0) {
+                    return 0;  // nothing produced here yet: the queue is empty
+                }
+                pos = dequeue_pos.load(memory_order_relaxed);
+                continue;
+            }
+            if (dequeue_pos.compare_exchange_weak(pos, pos + ready, memory_order_relaxed)) {
+                for (size_t i{}; i < ready; i++) {
+                    auto& cell = cells[(pos + i) & mask];
+                    values[i] = move(cell.value);
+                    cell.sequence.store(pos + i + mask + 1, memory_order_release);
+                }
+                return ready;
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t round_up(size_t capacity) {
+        size_t size { 2 };
+        while (size < capacity) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    // How many cells from pos on are in the state we need (offset 0: empty for producers, 1: full for consumers)
+    size_t count_ready(size_t pos, size_t n, size_t offset) const {
+        size_t ready{};
+        while (ready < n && ready <= mask &&
+               cells[(pos + ready) & mask].sequence.load(memory_order_acquire) == pos + ready + offset) {
+            ready++;
+        }
+        return ready;
+    }
+
+    const size_t mask;
+    Cell* const cells;
+    alignas(64) atomic<size_t> enqueue_pos{};
+    alignas(64) atomic<size_t> dequeue_pos{};
+};
+
+/*
+    Blocking wrapper: spin on the lock-free calls for a while (the other side is usually only nanoseconds away)
+    and then park on a C++20 atomic wait, which sleeps in the kernel (futex) until the other side notifies.
+    The notifying side only pays for notify_all when someone is actually parked.
+*/
+template <typename T>
+class BlockingMpmcRing {
+public:
+    explicit BlockingMpmcRing(size_t capacity) : ring{ capacity } { }
+
+    void push(const T& value) { push_n(&value, 1); }
+    T pop() {
+        T value;
+        pop_n(&value, 1);
+        return value;
+    }
+
+    // Blocks until all n values are in
+    void push_n(const T* values, size_t n) {
+        while (n > 0) {
+            const auto pushed = wait_for(not_full, [&] { return ring.try_push_n(values, n); });
+            values += pushed;
+            n -= pushed;
+            signal(not_empty);
+        }
+    }
+
+    // Blocks until at least one value is available, returns how many were popped (up to n; 0 only for n == 0)
+    size_t pop_n(T* values, size_t n) {
+        if (n == 0) {
+            return 0;
+        }
+        const auto popped = wait_for(not_empty, [&] { return ring.try_pop_n(values, n); });
+        signal(not_full);
+        return popped;
+    }
+
+private:
+    struct Event {
+        atomic<uint32_t> epoch{};
+        atomic<uint32_t> waiters{};
+    };
+
+    template <typename Attempt>
+    size_t wait_for(Event& event, Attempt attempt) {
+        for (size_t spin{}; spin < spin_limit; spin++) {
+            if (const auto done = attempt()) {
+                return done;
+            }
+            this_thread::yield();
+        }
+        for (;;) {
+            const auto epoch = event.epoch.load();
+            event.waiters.fetch_add(1);
+            // re-check after announcing ourselves, or a signal in between would be lost
+            const auto done = attempt();
+            if (done == 0) {
+                event.epoch.wait(epoch);
+            }
+            event.waiters.fetch_sub(1);
+            if (done) {
+                return done;
+            }
+        }
+    }
+
+    static void signal(Event& event) {
+        // The ring publishes with release stores, which may be reordered after the waiters load below. Without
+        // this fence we could read waiters == 0 while a waiter, after its fetch_add, still sees the old sequence
+        // and parks with nobody left to wake it. The fence pairs with the seq_cst fetch_add in wait_for.
+        atomic_thread_fence(memory_order_seq_cst);
+        if (event.waiters.load() > 0) {
+            event.epoch.fetch_add(1);
+            event.epoch.notify_all();
+        }
+    }
+
+    static constexpr size_t spin_limit { 64 };
+    MpmcRing<T> ring;
+    alignas(64) Event not_empty;
+    alignas(64) Event not_full;
+};
+
+/*
+    conditional_rodeo as a streaming pipeline: the eater no longer waits for all 1,000,000 cans to be deposited,
+    it eats them as they arrive through a 1024-can ring, in batches of up to 64.
+*/
+void streaming_rodeo() {
+    const size_t iterations{ 1'000'000 };
+    const size_t batch{ 64 };
+    BlockingMpmcRing<int> conveyor{ 1024 };
+    atomic<long> tin_cans_available{};
+
+    auto eat_cans = async(launch::async, [&] {
+        int cans[batch];
+        for (size_t eaten{}; eaten < iterations; ) {
+            const auto n = conveyor.pop_n(cans, batch);
+            for (size_t i{}; i < n; i++) {
+                tin_cans_available.fetch_sub(cans[i], memory_order_relaxed);
+            }
+            eaten += n;
+        }
+    });
+
+    auto deposit_cans = async(launch::async, [&] {
+        int cans[batch];
+        for (size_t deposited{}; deposited < iterations; deposited += batch) {
+            const auto n = min(batch, iterations - deposited);
+            for (size_t i{}; i < n; i++) {
+                cans[i] = 1;
+            }
+            tin_cans_available.fetch_add(static_cast<long>(n), memory_order_relaxed);
+            conveyor.push_n(cans, n);
+        }
+    });
+
+    eat_cans.get();
+    deposit_cans.get();
+
+    cout << "Tin cans available: " << tin_cans_available << endl;
+}
+
+// The same stream with the textbook std::queue + mutex + condition_variable, one lock round trip per can
+void queue_rodeo() {
+    const size_t iterations{ 1'000'000 };
+    mutex m;
+    condition_variable cv;
+    queue<int> conveyor;
+    long tin_cans_available{};
+
+    auto eat_cans = async(launch::async, [&] {
+        for (size_t i{}; i < iterations; i++) {
+            unique_lock<mutex> lock{ m };
+            cv.wait(lock, [&] { return !conveyor.empty(); });
+            tin_cans_available -= conveyor.front();
+            conveyor.pop();
+        }
+    });
+
+    auto deposit_cans = async(launch::async, [&] {
+        for (size_t i{}; i < iterations; i++) {
+            {
+                scoped_lock<mutex> lock{ m };
+                tin_cans_available++;
+                conveyor.push(1);
+            }
+            cv.notify_one();
+        }
+    });
+
+    eat_cans.get();
+    deposit_cans.get();
+
+    cout << "Tin cans available: " << tin_cans_available << endl;
+}
+
+// Several producers and consumers hammering one ring; every value must come out exactly once
+void mpmc_rodeo(size_t producers, size_t consumers) {
+    const size_t per_producer { 200'000 };
+    BlockingMpmcRing<size_t> ring{ 256 };
+    atomic<size_t> consumed{}, sum{};
+
+    vector<future<void>> workers;
+    for (size_t p{}; p < producers; p++) {
+        workers.push_back(async(launch::async, [&, p] {
+            for (size_t i{}; i < per_producer; i++) {
+                ring.push(p * per_producer + i + 1);
+            }
+        }));
+    }
+    const auto total = producers * per_producer;
+    for (size_t c{}; c < consumers; c++) {
+        workers.push_back(async(launch::async, [&] {
+            size_t values[32];
+            while (consumed.load() < total) {
+                // claim before popping, so consumers never wait for values nobody will push
+                const auto want = min<size_t>(32, total - min(total, consumed.fetch_add(32)));
+                if (want == 0) {
+                    break;
+                }
+                for (size_t got{}; got < want; ) {
+                    const auto n = ring.pop_n(values, want - got);
+                    for (size_t i{}; i < n; i++) {
+                        sum.fetch_add(values[i], memory_order_relaxed);
+                    }
+                    got += n;
+                }
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.get();
+    }
+    cout << "MPMC " << producers << "x" << consumers << ": "
+         << (sum.load() == total * (total + 1) / 2 ? "every value arrived once" : "VALUES LOST OR DUPLICATED") << endl;
+}
+
+/*
+    Rodeo benchmark harness: the same increment/decrement workload as the rodeos above, but with a configurable
+    number of threads and iterations, so we can pick a primitive for hot counters from data.
+        - Half of the threads (rounded down) eat cans, the rest deposit them, every thread does `iterations` ops.
+        - ns/op is wall-clock time over every operation of every thread.
+        - Latency percentiles come from timing every `sample_every`-th operation on its own. The cost of reading
+          the clock is measured up front and subtracted, so the samples show the operation and not steady_clock.
+        - The final count is checked against what the workload should leave behind.
+
+    Every counter has the same shape: increment(slot), decrement(slot) and read(), where slot is the thread index
+    (only the striped counter cares about it).
+*/
+
+// goat_rodeo: explicit lock/unlock
+struct MutexCounter {
+    static constexpr const char* name = "mutex";
+    void increment(size_t) { m.lock(); count++; m.unlock(); }
+    void decrement(size_t) { m.lock(); count--; m.unlock(); }
+    long read() { lock_guard<mutex> guard{ m }; return count; }
+private:
+    mutex m;
+    long count{};
+};
+
+// raii_rodeo: lock_guard
+struct LockGuardCounter {
+    static constexpr const char* name = "lock_guard";
+    void increment(size_t) { lock_guard<mutex> guard{ m }; count++; }
+    void decrement(size_t) { lock_guard<mutex> guard{ m }; count--; }
+    long read() { lock_guard<mutex> guard{ m }; return count; }
+private:
+    mutex m;
+    long count{};
+};
+
+/*
+    Spinlock with exponential backoff: test-and-test-and-set, so waiting threads spin on a plain load (the cache line
+    stays shared) instead of hammering it with exchanges. Every failed attempt doubles the number of pause
+    instructions up to a cap, after which the thread yields - on an oversubscribed machine the lock holder may not
+    even be running.
+*/
+class Spinlock {
+public:
+    void lock() {
+        size_t backoff { 1 };
+        while (locked.exchange(true, memory_order_acquire)) {
+            while (locked.load(memory_order_relaxed)) {
+                if (backoff > max_backoff) {
+                    this_thread::yield();
+                    continue;
+                }
+                for (size_t i{}; i < backoff; i++) {
+                    pause();
+                }
+                backoff *= 2;
+            }
+        }
+    }
+    void unlock() { locked.store(false, memory_order_release); }
 
-    raii_rodeo();
-    raii_rodeo();
-    raii_rodeo();
+private:
+    static constexpr size_t max_backoff { 1024 };
+    static void pause() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+    atomic<bool> locked{};
+};
+
+struct SpinlockCounter {
+    static constexpr const char* name = "spinlock_backoff";
+    void increment(size_t) { lock_guard<Spinlock> guard{ lock }; count++; }
+    void decrement(size_t) { lock_guard<Spinlock> guard{ lock }; count--; }
+    long read() { lock_guard<Spinlock> guard{ lock }; return count; }
+private:
+    Spinlock lock;
+    long count{};
+};
+
+// atomic_rodeo: ++/-- on an atomic are sequentially consistent read-modify-writes
+struct AtomicCounter {
+    static constexpr const char* name = "atomic_seq_cst";
+    void increment(size_t) { count++; }
+    void decrement(size_t) { count--; }
+    long read() { return count; }
+private:
+    atomic<long> count{};
+};
+
+// A counter orders nothing else, so relaxed is enough. On x86 this is the same lock xadd; on ARM it drops the barriers.
+struct RelaxedAtomicCounter {
+    static constexpr const char* name = "atomic_relaxed";
+    void increment(size_t) { count.fetch_add(1, memory_order_relaxed); }
+    void decrement(size_t) { count.fetch_sub(1, memory_order_relaxed); }
+    long read() { return count.load(memory_order_relaxed); }
+private:
+    atomic<long> count{};
+};
+
+/*
+    Striped counter: every thread owns a cache-line-sized slot, so increments never contend, and read() adds the slots
+    together. Writes are as cheap as they get; reads are O(stripes) and only see a snapshot that may already be stale.
+*/
+struct StripedCounter {
+    static constexpr const char* name = "striped";
+    static constexpr size_t stripes { 64 };
+    // still a read-modify-write: with more than 64 threads two threads share a slot
+    void increment(size_t slot) { slots[slot % stripes].count.fetch_add(1, memory_order_relaxed); }
+    void decrement(size_t slot) { slots[slot % stripes].count.fetch_sub(1, memory_order_relaxed); }
+    long read() {
+        long total{};
+        for (auto& slot : slots) {
+            total += slot.count.load(memory_order_relaxed);
+        }
+        return total;
+    }
+private:
+    struct alignas(64) Slot {
+        atomic<long> count{};
+    };
+    Slot slots[stripes];
+};
+
+// conditional_rodeo: eaters block until a can is available, so the count never goes negative
+struct ConditionCounter {
+    static constexpr const char* name = "condition_variable";
+    void increment(size_t) {
+        {
+            lock_guard<mutex> guard{ m };
+            count++;
+        }
+        cv.notify_one();
+    }
+    void decrement(size_t) {
+        unique_lock<mutex> lock{ m };
+        cv.wait(lock, [&] { return count > 0; });
+        count--;
+    }
+    long read() { lock_guard<mutex> guard{ m }; return count; }
+private:
+    mutex m;
+    condition_variable cv;
+    long count{};
+};
+
+struct RodeoConfig {
+    vector<size_t> thread_counts{ 1, 2, 4, 8 };
+    size_t iterations{ 1'000'000 };
+    size_t sample_every{ 64 };
+    bool json{};
+};
+
+struct RodeoResult {
+    const char* name;
+    size_t threads;
+    size_t iterations;
+    double ns_per_op;
+    double p50_ns, p90_ns, p99_ns, p999_ns, max_ns;
+    long final_count;
+    long expected_count;
+};
+
+// Median cost of two back-to-back steady_clock::now() calls
+double clock_overhead_ns() {
+    vector<double> samples(10'001);
+    for (auto& sample : samples) {
+        const auto start = chrono::steady_clock::now();
+        const auto stop = chrono::steady_clock::now();
+        sample = chrono::duration<double, nano>(stop - start).count();
+    }
+    nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+template <typename Counter>
+RodeoResult run_rodeo(size_t threads, const RodeoConfig& config, double clock_overhead) {
+    Counter counter;
+    const auto iterations = config.iterations;
+    const auto eaters = threads / 2;
+    atomic<size_t> ready{};
+    atomic<bool> go{};
+    vector<vector<float>> samples(threads);
+
+    vector<future<void>> workers;
+    for (size_t t{}; t < threads; t++) {
+        workers.push_back(async(launch::async, [&, t] {
+            const bool eat = t < eaters;
+            auto& mine = samples[t];
+            mine.reserve(iterations / config.sample_every + 1);
+            ready++;
+            while (!go.load(memory_order_acquire)) {
+                this_thread::yield();
+            }
+            for (size_t i{}; i < iterations; i++) {
+                if (i % config.sample_every == 0) {
+                    const auto start = chrono::steady_clock::now();
+                    eat ? counter.decrement(t) : counter.increment(t);
+                    const auto stop = chrono::steady_clock::now();
+                    mine.push_back(static_cast<float>(chrono::duration<double, nano>(stop - start).count() - clock_overhead));
+                } else {
+                    eat ? counter.decrement(t) : counter.increment(t);
+                }
+            }
+        }));
+    }
+    while (ready.load() < threads) {
+        this_thread::yield();
+    }
+    const auto start = chrono::steady_clock::now();
+    go.store(true, memory_order_release);
+    for (auto& worker : workers) {
+        worker.get();
+    }
+    const chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+
+    vector<float> all;
+    for (auto& mine : samples) {
+        all.insert(all.end(), mine.begin(), mine.end());
+    }
+    sort(all.begin(), all.end());
+    auto percentile = [&](double p) {
+        return all.empty() ? 0.0 : max(0.0, static_cast<double>(all[static_cast<size_t>(p * (all.size() - 1))]));
+    };
+
+    return RodeoResult {
+        Counter::name, threads, iterations,
+        elapsed.count() / static_cast<double>(threads * iterations),
+        percentile(0.5), percentile(0.9), percentile(0.99), percentile(0.999), percentile(1.0),
+        counter.read(),
+        static_cast<long>((threads - 2 * eaters) * iterations)
+    };
+}
+
+void print_result(const RodeoResult& r, bool json, bool first) {
+    if (json) {
+        printf("%s\n  {\"primitive\": \"%s\", \"threads\": %zu, \"iterations\": %zu, \"ns_per_op\": %.3f, "
+               "\"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"p999_ns\": %.1f, \"max_ns\": %.1f, "
+               "\"final_count\": %ld, \"expected_count\": %ld}",
+               first ? "" : ",", r.name, r.threads, r.iterations, r.ns_per_op,
+               r.p50_ns, r.p90_ns, r.p99_ns, r.p999_ns, r.max_ns, r.final_count, r.expected_count);
+        return;
+    }
+    printf("%-20s %7zu %10.2f %9.0f %9.0f %9.0f %9.0f %11.0f  %s\n", r.name, r.threads, r.ns_per_op,
+           r.p50_ns, r.p90_ns, r.p99_ns, r.p999_ns, r.max_ns, r.final_count == r.expected_count ? "ok" : "WRONG COUNT");
+}
+
+template <typename... Counters>
+void run_rodeos(const RodeoConfig& config) {
+    const auto overhead = clock_overhead_ns();
+    if (config.json) {
+        printf("[");
+    } else {
+        printf("%zu iterations per thread, latency sampled every %zu ops (clock overhead %.0f ns subtracted)\n",
+               config.iterations, config.sample_every, overhead);
+        printf("%-20s %7s %10s %9s %9s %9s %9s %11s  %s\n",
+               "primitive", "threads", "ns/op", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns", "count");
+    }
+    bool first { true };
+    for (auto threads : config.thread_counts) {
+        ((print_result(run_rodeo<Counters>(threads, config, overhead), config.json, first), first = false), ...);
+    }
+    if (config.json) {
+        printf("\n]\n");
+    }
+}
+
+// Usage: ccc-19_mutex [--threads 1,2,4,8] [--iterations N] [--sample-every N] [--json] [--demo]
+int main(int argc, char** argv) {
+    RodeoConfig config;
+    bool demo{};
+    for (int i { 1 }; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--json") == 0) {
+            config.json = true;
+        } else if (strcmp(argv[i], "--demo") == 0) {
+            demo = true;
+        } else if (strcmp(argv[i], "--iterations") == 0 && has_value) {
+            config.iterations = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--sample-every") == 0 && has_value) {
+            config.sample_every = max<size_t>(1, strtoull(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            config.thread_counts.clear();
+            for (auto list = argv[++i]; *list; ) {
+                char* end;
+                const auto threads = strtoull(list, &end, 10);
+                if (end == list) {
+                    break;
+                }
+                if (threads > 0) {
+                    config.thread_counts.push_back(threads);
+                }
+                list = *end == ',' ? end + 1 : end;
+            }
+        } else {
+            fprintf(stderr, "usage: %s [--threads 1,2,4,8] [--iterations N] [--sample-every N] [--json] [--demo]\n", argv[0]);
+            return 1;
+        }
+    }
 
-    atomic_rodeo();
-    atomic_rodeo();
-    atomic_rodeo();
+    // The original rodeos, for the "Tin cans available: 0" sanity check, and the two producer/consumer flavours timed
+    if (demo) {
+        goat_rodeo();
+        raii_rodeo();
+        atomic_rodeo();
+        auto timed = [](const char* name, auto rodeo) {
+            const auto start = chrono::steady_clock::now();
+            rodeo();
+            const chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            printf("%s: %.1f ms\n", name, elapsed.count());
+        };
+        timed("conditional_rodeo (no pipelining)", conditional_rodeo);
+        timed("queue_rodeo (std::queue + condition_variable)", queue_rodeo);
+        timed("streaming_rodeo (MPMC ring)", streaming_rodeo);
+        mpmc_rodeo(2, 2);
+        mpmc_rodeo(3, 1);
+    }
 
-    conditional_rodeo();
-    conditional_rodeo();
-    conditional_rodeo();
+    run_rodeos<MutexCounter, LockGuardCounter, SpinlockCounter, AtomicCounter,
+               RelaxedAtomicCounter, StripedCounter, ConditionCounter>(config);
 
     return 0;
 }
\ No newline at end of file
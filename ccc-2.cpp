@@ -1,9 +1,162 @@
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <span>
+#include <array>
+#include <vector>
+#include <chrono>
+
+// SIMD batch kernels are picked at compile time: build with -mavx2 on x86, otherwise the scalar loops are used.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 enum class Operation {
     ADD, SUBSTRACT, MULTIPLY, DIVIDE
 };
 
+// Error flags, OR-ed together. Every result is still defined: overflow wraps around (two's complement), and
+// dividing by zero or with an unknown operation gives 0.
+enum CalcError : uint8_t {
+    CALC_OK = 0,
+    CALC_OVERFLOW = 1,          // the exact result doesn't fit in an int (including INT_MIN / -1)
+    CALC_DIVIDE_BY_ZERO = 2,
+    CALC_UNKNOWN_OPERATION = 4,
+};
+
+/*
+    One operation on one pair, chosen at compile time. The arithmetic happens in 64 bits, where it can't overflow,
+    and is then narrowed: the conversion wraps (defined behavior since C++20), and a mismatch flags an overflow.
+*/
+template <Operation Op>
+constexpr int apply_operation(int a, int b, uint8_t& error) {
+    int64_t exact {};
+    if constexpr (Op == Operation::ADD) exact = int64_t{ a } + b;
+    else if constexpr (Op == Operation::SUBSTRACT) exact = int64_t{ a } - b;
+    else if constexpr (Op == Operation::MULTIPLY) exact = int64_t{ a } * b;
+    else {
+        if (b == 0) {
+            error = CALC_DIVIDE_BY_ZERO;
+            return 0;
+        }
+        exact = int64_t{ a } / b;
+    }
+    const auto result = static_cast<int>(static_cast<uint32_t>(exact));
+    error = result == exact ? CALC_OK : CALC_OVERFLOW;
+    return result;
+}
+
+static_assert([] { uint8_t e{}; return apply_operation<Operation::DIVIDE>(INT_MIN, -1, e) == INT_MIN && e == CALC_OVERFLOW; }());
+static_assert([] { uint8_t e{}; return apply_operation<Operation::DIVIDE>(7, 0, e) == 0 && e == CALC_DIVIDE_BY_ZERO; }());
+
+#if defined(__AVX2__)
+// 8 lanes of Op, returning the results and per-lane overflow / divide-by-zero masks (all ones where set)
+template <Operation Op>
+inline __m256i apply_operation8(__m256i a, __m256i b, __m256i& overflow, __m256i& divide_by_zero) {
+    const auto zero = _mm256_setzero_si256();
+    divide_by_zero = zero;
+    if constexpr (Op == Operation::ADD || Op == Operation::SUBSTRACT) {
+        const auto result = Op == Operation::ADD ? _mm256_add_epi32(a, b) : _mm256_sub_epi32(a, b);
+        // add overflows when both inputs have the sign the result lacks; subtract when a and b differ in sign
+        // and the result's sign differs from a's
+        const auto flips = Op == Operation::ADD ? _mm256_and_si256(_mm256_xor_si256(a, result), _mm256_xor_si256(b, result))
+                                                : _mm256_and_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(a, result));
+        overflow = _mm256_srai_epi32(flips, 31);
+        return result;
+    } else if constexpr (Op == Operation::MULTIPLY) {
+        const auto result = _mm256_mullo_epi32(a, b);
+        // full 64-bit products of the even and the odd lanes; the product fits if its high half is just
+        // the sign extension of the low half
+        const auto even = _mm256_mul_epi32(a, b);
+        const auto odd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        const auto high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0b10101010);
+        overflow = _mm256_xor_si256(_mm256_cmpeq_epi32(high, _mm256_srai_epi32(result, 31)), _mm256_set1_epi32(-1));
+        return result;
+    } else {
+        /*
+            No integer divide instruction exists in AVX2, but doubles do it exactly: for 32-bit operands the rounding
+            error of a / b is below 2^-22 / |b| while the quotient is at least 1 / |b| away from the next integer, so
+            truncating the double quotient gives the integer quotient. Zero divisors get swapped for 1 first.
+        */
+        divide_by_zero = _mm256_cmpeq_epi32(b, zero);
+        const auto safe_b = _mm256_blendv_epi8(b, _mm256_set1_epi32(1), divide_by_zero);
+        const auto low = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(a)),
+                                                           _mm256_cvtepi32_pd(_mm256_castsi256_si128(safe_b))));
+        const auto high = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(a, 1)),
+                                                            _mm256_cvtepi32_pd(_mm256_extracti128_si256(safe_b, 1))));
+        // INT_MIN / -1 = 2^31 doesn't convert: cvttpd gives INT_MIN, which is also the wrapped result
+        overflow = _mm256_and_si256(_mm256_cmpeq_epi32(a, _mm256_set1_epi32(INT_MIN)),
+                                    _mm256_cmpeq_epi32(b, _mm256_set1_epi32(-1)));
+        return _mm256_andnot_si256(divide_by_zero, _mm256_set_m128i(high, low));
+    }
+}
+#endif
+
+// Whole batch of one operation: the operation is a template parameter, so there is no switch in the loop
+template <Operation Op>
+uint8_t calculate_kernel(const int* a, const int* b, int* out, uint8_t* errors, size_t n) {
+    uint8_t combined {};
+    size_t i {};
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m256i overflow, divide_by_zero;
+        const auto result = apply_operation8<Op>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)),
+                                                 overflow, divide_by_zero);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+        const auto overflow_bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(overflow)));
+        const auto zero_bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(divide_by_zero)));
+        combined |= (overflow_bits ? CALC_OVERFLOW : 0) | (zero_bits ? CALC_DIVIDE_BY_ZERO : 0);
+        if (errors) {
+            for (unsigned lane {}; lane < 8; lane++) {
+                errors[i + lane] = static_cast<uint8_t>(((overflow_bits >> lane) & 1) * CALC_OVERFLOW |
+                                                        ((zero_bits >> lane) & 1) * CALC_DIVIDE_BY_ZERO);
+            }
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        uint8_t error {};
+        out[i] = apply_operation<Op>(a[i], b[i], error);
+        if (errors) errors[i] = error;
+        combined |= error;
+    }
+    return combined;
+}
+
+/*
+    Mixed-operation streams: a counting sort of the element indices by operation, so each operation can then run as
+    one batch. order holds the indices grouped ADD, SUBSTRACT, MULTIPLY, DIVIDE, then unknown values; group g is
+    order[offsets[g]] up to order[offsets[g + 1]].
+*/
+struct OperationGroups {
+    static const size_t n_groups { 5 };
+    std::vector<uint32_t> order;
+    std::array<size_t, n_groups + 1> offsets {};
+};
+
+inline size_t operation_group(Operation op) {
+    const auto group = static_cast<size_t>(op);
+    return group < OperationGroups::n_groups - 1 ? group : OperationGroups::n_groups - 1;
+}
+
+void group_by_operation(std::span<const Operation> ops, OperationGroups& groups) {
+    groups.offsets = {};
+    for (const auto op : ops) groups.offsets[operation_group(op) + 1]++;
+    for (size_t g {}; g < OperationGroups::n_groups; g++) groups.offsets[g + 1] += groups.offsets[g];
+    groups.order.resize(ops.size());
+    auto next = groups.offsets;
+    for (size_t i {}; i < ops.size(); i++) groups.order[next[operation_group(ops[i])]++] = static_cast<uint32_t>(i);
+}
+
+OperationGroups group_by_operation(std::span<const Operation> ops) {
+    OperationGroups groups;
+    group_by_operation(ops, groups);
+    return groups;
+}
+
 
 // Struct: A class where everything is public by default
 struct Calculator {
@@ -20,30 +173,90 @@ struct Calculator {
         op = operation;
     }
 
-    int calculate(int a, int b) {
+    // Errors are OR-ed into *errors when given; the result is defined either way (see CalcError)
+    int calculate(int a, int b, uint8_t* errors = nullptr) const {
+        uint8_t error {};
+        int result {};
         switch(op) {
             case Operation::ADD: {
-                return a + b;
+                result = apply_operation<Operation::ADD>(a, b, error);
                 break;
             }
             case Operation::SUBSTRACT: {
-                return a - b;
+                result = apply_operation<Operation::SUBSTRACT>(a, b, error);
                 break;
             }
             case Operation::MULTIPLY: {
-                return a * b;
+                result = apply_operation<Operation::MULTIPLY>(a, b, error);
                 break;
             }
             case Operation::DIVIDE: {
-                return a / b;
+                result = apply_operation<Operation::DIVIDE>(a, b, error);
                 break;
             }
             default: {
-                printf("Unkown Operation");
-                return 0;
+                error = CALC_UNKNOWN_OPERATION;
                 break;
             }
         }
+        if (errors) *errors |= error;
+        return result;
+    }
+
+    /*
+        Batch version: out[i] = a[i] op b[i] over the shortest of the spans, switching on the operation once per
+        batch instead of once per pair. Returns the OR of all errors; when given, errors[i] gets element i's flags.
+    */
+    static uint8_t calculate_batch(Operation operation, std::span<const int> a, std::span<const int> b, std::span<int> out,
+                                   std::span<uint8_t> errors = {}) {
+        auto n = a.size() < b.size() ? a.size() : b.size();
+        n = n < out.size() ? n : out.size();
+        const auto error_out = errors.size() >= n ? errors.data() : nullptr;
+        switch (operation) {
+            case Operation::ADD: return calculate_kernel<Operation::ADD>(a.data(), b.data(), out.data(), error_out, n);
+            case Operation::SUBSTRACT: return calculate_kernel<Operation::SUBSTRACT>(a.data(), b.data(), out.data(), error_out, n);
+            case Operation::MULTIPLY: return calculate_kernel<Operation::MULTIPLY>(a.data(), b.data(), out.data(), error_out, n);
+            case Operation::DIVIDE: return calculate_kernel<Operation::DIVIDE>(a.data(), b.data(), out.data(), error_out, n);
+        }
+        std::memset(out.data(), 0, n * sizeof(int));
+        if (error_out) std::memset(error_out, CALC_UNKNOWN_OPERATION, n);
+        return n ? CALC_UNKNOWN_OPERATION : CALC_OK;
+    }
+
+    /*
+        Mixed operations (ops, a, b and out the same length): group by operation, gather each group into contiguous
+        buffers, run it as a batch and scatter back. This goes block by block so the gathers and scatters stay in
+        cache; over the whole stream at once they'd miss on nearly every element.
+    */
+    static uint8_t calculate_mixed(std::span<const Operation> ops, std::span<const int> a, std::span<const int> b,
+                                   std::span<int> out, std::span<uint8_t> errors = {}) {
+        const size_t block { 2048 };
+        OperationGroups groups;
+        std::vector<int> group_a(block), group_b(block), group_out(block);
+        std::vector<uint8_t> group_errors(block);
+        uint8_t combined {};
+        for (size_t base {}; base < ops.size(); base += block) {
+            const auto count = ops.size() - base < block ? ops.size() - base : block;
+            group_by_operation(ops.subspan(base, count), groups);
+            for (size_t k {}; k < count; k++) {
+                group_a[k] = a[base + groups.order[k]];
+                group_b[k] = b[base + groups.order[k]];
+            }
+            for (size_t g {}; g < OperationGroups::n_groups; g++) {
+                const auto first = groups.offsets[g], last = groups.offsets[g + 1];
+                if (first == last) continue;
+                combined |= calculate_batch(ops[base + groups.order[first]],
+                                            std::span<const int>(group_a).subspan(first, last - first),
+                                            std::span<const int>(group_b).subspan(first, last - first),
+                                            std::span<int>(group_out).subspan(first, last - first),
+                                            std::span<uint8_t>(group_errors).subspan(first, last - first));
+            }
+            for (size_t k {}; k < count; k++) {
+                out[base + groups.order[k]] = group_out[k];
+                if (!errors.empty()) errors[base + groups.order[k]] = group_errors[k];
+            }
+        }
+        return combined;
     }
 
     private:
@@ -63,7 +276,54 @@ class Earth {
         }
 };
 
-int main() {
+// Usage: ccc-2 --batch [N]   runs this instead of the demo (N defaults to 1M)
+// A million pairs: one calculate() per pair against one batch, then a mixed-operation stream
+void benchmark_calculator(size_t n) {
+    std::vector<int> a(n), b(n), out(n), reference(n);
+    std::vector<Operation> ops(n);
+    uint32_t state { 0xCA1C };
+    for (size_t i {}; i < n; i++) {
+        state = state * 1664525 + 1013904223;
+        a[i] = static_cast<int>(state);
+        state = state * 1664525 + 1013904223;
+        b[i] = static_cast<int>(state) >> (state % 31);  // every size of divisor, zero now and then
+        ops[i] = static_cast<Operation>(state >> 30);
+    }
+    using nanos = std::chrono::duration<double, std::nano>;
+    auto time = [&](const char* name, auto&& run) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        printf("%-36s %6.2f ns/pair\n", name, nanos(std::chrono::steady_clock::now() - start).count() / n);
+    };
+
+    const char* names[] { "ADD", "SUBSTRACT", "MULTIPLY", "DIVIDE" };
+    for (auto op : { Operation::ADD, Operation::MULTIPLY, Operation::DIVIDE }) {
+        char label[64];
+        Calculator calc { op };
+        snprintf(label, sizeof(label), "%s calculate() per pair", names[static_cast<int>(op)]);
+        time(label, [&] { for (size_t i {}; i < n; i++) reference[i] = calc.calculate(a[i], b[i]); });
+        snprintf(label, sizeof(label), "%s calculate_batch", names[static_cast<int>(op)]);
+        uint8_t errors {};
+        time(label, [&] { errors = Calculator::calculate_batch(op, a, b, out); });
+        printf("    same results: %s, errors 0x%x\n", out == reference ? "yes" : "NO", errors);
+    }
+    time("mixed: setOperation + calculate()", [&] {
+        Calculator calc;
+        for (size_t i {}; i < n; i++) {
+            calc.setOperation(ops[i]);
+            reference[i] = calc.calculate(a[i], b[i]);
+        }
+    });
+    time("mixed: calculate_mixed (grouped)", [&] { Calculator::calculate_mixed(ops, a, b, out); });
+    printf("    same results: %s\n", out == reference ? "yes" : "NO");
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+        benchmark_calculator(argc == 3 ? strtoull(argv[2], nullptr, 10) : 1'000'000);
+        return 0;
+    }
+
     Earth newEarth {};
 
     Calculator calc(Operation::ADD);
@@ -77,5 +337,18 @@ int main() {
 
     calc.setOperation(Operation::DIVIDE);
     printf("Result of %d / %d is: %d\n", 10, 10, calc.calculate(10, 10));
+
+    // Used to crash: now 0 with a flag
+    uint8_t errors {};
+    const auto quotient = calc.calculate(10, 0, &errors);
+    printf("Result of %d / %d is: %d (divide by zero flagged: %s)\n", 10, 0, quotient, errors & CALC_DIVIDE_BY_ZERO ? "yes" : "no");
+
+    const int lhs[] { 10, 20, 30, INT_MIN, 50, 60, 70, 80, 90 };
+    const int rhs[] { 10, 0, 3, -1, 7, -6, 5, 4, 0 };
+    int quotients[9];
+    uint8_t flags[9];
+    const auto combined = Calculator::calculate_batch(Operation::DIVIDE, lhs, rhs, quotients, flags);
+    for (size_t i {}; i < 9; i++) printf("%d / %d = %d (flags %d)\n", lhs[i], rhs[i], quotients[i], flags[i]);
+    printf("Combined flags: %d\n", combined);
     return 0;
 }
\ No newline at end of file
@@ -1,4 +1,11 @@
 #include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <list>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
 
 using namespace std;
 
@@ -89,13 +96,14 @@ struct Element {
 
     void insert_after(Element* next_element) {
         // Arrow operator: Used to access members of struct/class pointers
+        if (next) next->previous = next_element; // the old next now points back at the new element
         next_element->next = next;
         next_element-> previous = this;
         next = next_element;
     }
 
     void insert_before(Element* new_previous) {
-        previous->next = new_previous;
+        if (previous) previous->next = new_previous; // the head has no previous to update
         new_previous->previous = previous;
         new_previous->next = this;
         previous = new_previous;
@@ -107,7 +115,244 @@ struct Element {
     }
 };
 
-int main() {
+/*
+    ElementList: the same doubly linked list of (prefix, operating_number), stored the cache-friendly way.
+        - Nodes live in an arena of fixed-size chunks (4096 nodes each), not in separately allocated objects.
+          Nodes created one after another sit next to each other, so walking the list mostly walks memory in order.
+          Growing the arena never moves a node.
+        - Links are 32-bit indices into the arena instead of 64-bit pointers. A node is 24 bytes; a std::list node
+          with the same payload is 32 bytes plus the allocator's header.
+        - Erased slots go on a free list threaded through their next links and are reused first.
+        - Inserting, erasing and splicing (moving a node elsewhere in the list) are still O(1) relinks.
+        - compact() rewrites the arena in list order after a lot of random inserts, so iteration is sequential
+          again. It renumbers every node, so indices from before are invalid afterwards.
+        - forward(from) / backward(from) are the two traversal loops in main: next links from the given node,
+          or previous links back to the head.
+    Indices belong to one list.
+*/
+class ElementList {
+public:
+    using Index = uint32_t;
+    static const Index none { UINT32_MAX };
+
+    struct Node {
+        Index next { none };
+        Index previous { none };
+        const char* prefix {};
+        short operating_number {};
+    };
+
+    template <bool Forward>
+    struct Iterator {
+        const ElementList* list;
+        Index index;
+
+        const Node& operator*() const { return list->node(index); }
+        const Node* operator->() const { return &list->node(index); }
+        Iterator& operator++() {
+            index = Forward ? list->node(index).next : list->node(index).previous;
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+    };
+
+    template <bool Forward>
+    struct Range {
+        Iterator<Forward> first;
+        Iterator<Forward> begin() const { return first; }
+        Iterator<Forward> end() const { return { first.list, none }; }
+    };
+
+    Range<true> forward(Index from) const { return { { this, from } }; }
+    Range<true> forward() const { return forward(head_index); }
+    Range<false> backward(Index from) const { return { { this, from } }; }
+    Range<false> backward() const { return backward(tail_index); }
+    Iterator<true> begin() const { return { this, head_index }; }
+    Iterator<true> end() const { return { this, none }; }
+
+    Node& operator[](Index index) { return node(index); }
+    const Node& operator[](Index index) const { return node(index); }
+    Index head() const { return head_index; }
+    Index tail() const { return tail_index; }
+    size_t size() const { return count; }
+
+    Index push_back(const char* prefix, short operating_number) {
+        return tail_index == none ? link_first(prefix, operating_number) : insert_after(tail_index, prefix, operating_number);
+    }
+
+    Index push_front(const char* prefix, short operating_number) {
+        return head_index == none ? link_first(prefix, operating_number) : insert_before(head_index, prefix, operating_number);
+    }
+
+    Index insert_after(Index at, const char* prefix, short operating_number) {
+        const auto index = allocate(prefix, operating_number);
+        link_after(at, index);
+        return index;
+    }
+
+    // Works on the head too: the new node simply becomes the head
+    Index insert_before(Index at, const char* prefix, short operating_number) {
+        const auto index = allocate(prefix, operating_number);
+        link_before(at, index);
+        return index;
+    }
+
+    void erase(Index index) {
+        unlink(index);
+        auto& erased = node(index);
+        erased.next = free_head;
+        free_head = index;
+        count--;
+    }
+
+    // Moves an existing node to just before `at`: O(1), nothing is copied
+    void splice_before(Index at, Index moved) {
+        if (at == moved) return;
+        unlink(moved);
+        link_before(at, moved);
+    }
+
+    void compact() {
+        std::vector<std::unique_ptr<Node[]>> packed;
+        Index position {};
+        for (auto index = head_index; index != none; index = node(index).next, position++) {
+            if (position % chunk_size == 0) packed.push_back(std::make_unique<Node[]>(chunk_size));
+            auto& copy = packed.back()[position % chunk_size];
+            copy = node(index);
+            copy.previous = position == 0 ? none : position - 1;
+            copy.next = position + 1 == count ? none : position + 1;
+        }
+        chunks = std::move(packed);
+        head_index = count ? 0 : none;
+        tail_index = count ? static_cast<Index>(count - 1) : none;
+        carved = static_cast<Index>(count);
+        free_head = none;
+    }
+
+private:
+    static const Index chunk_size { 4096 };
+
+    Node& node(Index index) { return chunks[index / chunk_size][index % chunk_size]; }
+    const Node& node(Index index) const { return chunks[index / chunk_size][index % chunk_size]; }
+
+    Index allocate(const char* prefix, short operating_number) {
+        Index index;
+        if (free_head != none) {
+            index = free_head;
+            free_head = node(index).next;
+        } else {
+            if (carved % chunk_size == 0) chunks.push_back(std::make_unique<Node[]>(chunk_size));
+            index = carved++;
+        }
+        node(index) = { none, none, prefix, operating_number };
+        count++;
+        return index;
+    }
+
+    Index link_first(const char* prefix, short operating_number) {
+        head_index = tail_index = allocate(prefix, operating_number);
+        return head_index;
+    }
+
+    void link_after(Index at, Index index) {
+        auto& before = node(at);
+        auto& inserted = node(index);
+        inserted.previous = at;
+        inserted.next = before.next;
+        if (before.next != none) node(before.next).previous = index;
+        else tail_index = index;
+        before.next = index;
+    }
+
+    void link_before(Index at, Index index) {
+        auto& after = node(at);
+        auto& inserted = node(index);
+        inserted.next = at;
+        inserted.previous = after.previous;
+        if (after.previous != none) node(after.previous).next = index;
+        else head_index = index;
+        after.previous = index;
+    }
+
+    void unlink(Index index) {
+        auto& removed = node(index);
+        if (removed.previous != none) node(removed.previous).next = removed.next;
+        else head_index = removed.next;
+        if (removed.next != none) node(removed.next).previous = removed.previous;
+        else tail_index = removed.previous;
+        removed.next = removed.previous = none;
+    }
+
+    std::vector<std::unique_ptr<Node[]>> chunks;
+    Index carved {};  // slots handed out from the chunks so far
+    Index free_head { none };
+    Index head_index { none };
+    Index tail_index { none };
+    size_t count {};
+};
+
+struct ListPayload {
+    const char* prefix;
+    short operating_number;
+};
+
+// Usage: ccc-3 --lists [N]   runs this instead of the demo (N defaults to 1M)
+// 1M nodes through ElementList and std::list: appends, both traversals, inserts at random positions, and
+// traversal of the resulting shuffled order (before and after compact())
+void benchmark_lists(size_t n) {
+    using millis = std::chrono::duration<double, std::milli>;
+    auto time = [](const char* name, auto&& run) {
+        const auto start = std::chrono::steady_clock::now();
+        const long long check = run();
+        printf("%-44s %8.2f ms (check %lld)\n", name, millis(std::chrono::steady_clock::now() - start).count(), check);
+    };
+    uint32_t state { 0x3c3 };
+    std::vector<uint32_t> positions(n);
+    for (auto& position : positions) {
+        state = state * 1664525 + 1013904223;
+        position = state;
+    }
+
+    ElementList arena;
+    std::list<ListPayload> list;
+    time("ElementList push_back", [&] { for (size_t i{}; i < n; i++) arena.push_back("EL", static_cast<short>(i)); return static_cast<long long>(arena.size()); });
+    time("std::list push_back", [&] { for (size_t i{}; i < n; i++) list.push_back({ "SL", static_cast<short>(i) }); return static_cast<long long>(list.size()); });
+    auto sum_forward = [](const auto& range) { long long sum{}; for (const auto& node : range) sum += node.operating_number; return sum; };
+    time("ElementList forward traversal", [&] { return sum_forward(arena.forward()); });
+    time("std::list forward traversal", [&] { return sum_forward(list); });
+    time("ElementList backward traversal", [&] { return sum_forward(arena.backward()); });
+    time("std::list backward traversal", [&] {
+        long long sum{};
+        for (auto node = list.rbegin(); node != list.rend(); ++node) sum += node->operating_number;
+        return sum;
+    });
+
+    // positions are picked from handles kept while building, as a real user of a list would
+    std::vector<ElementList::Index> arena_handles;
+    std::vector<std::list<ListPayload>::iterator> list_handles;
+    for (auto index = arena.head(); index != ElementList::none; index = arena[index].next) arena_handles.push_back(index);
+    for (auto node = list.begin(); node != list.end(); ++node) list_handles.push_back(node);
+    time("ElementList insert_after random node", [&] {
+        for (size_t i{}; i < n; i++) arena_handles.push_back(arena.insert_after(arena_handles[positions[i] % arena_handles.size()], "EL", 1));
+        return static_cast<long long>(arena.size());
+    });
+    time("std::list insert after random node", [&] {
+        for (size_t i{}; i < n; i++) list_handles.push_back(list.insert(std::next(list_handles[positions[i] % list_handles.size()]), { "SL", 1 }));
+        return static_cast<long long>(list.size());
+    });
+    time("ElementList traversal, shuffled order", [&] { return sum_forward(arena.forward()); });
+    time("std::list traversal, shuffled order", [&] { return sum_forward(list); });
+    time("ElementList compact()", [&] { arena.compact(); return static_cast<long long>(arena.size()); });
+    time("ElementList traversal after compact()", [&] { return sum_forward(arena.forward()); });
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "--lists") == 0) {
+        benchmark_lists(argc == 3 ? strtoull(argv[2], nullptr, 10) : 1'000'000);
+        return 0;
+    }
+
     int my_int { 5 };
     int* my_ptr { &my_int };
 
@@ -164,6 +409,27 @@ int main() {
         printf("OH NO GOING BACKWARDS! %d, %s\n", elem->operating_number, elem->prefix);
     }
 
+    // Inserting before the head used to dereference its null previous
+    Element zeroth { "ZZ", 0 };
+    first.insert_before(&zeroth);
+    printf("Before the head: %d, %s\n", first.previous->operating_number, first.previous->prefix);
+
+    // The same list, arena-backed: indices instead of pointers
+    ElementList elements;
+    const auto first_index = elements.push_back("KT", 1);
+    const auto second_index = elements.insert_after(first_index, "BC", 2);
+    elements[first_index].prefix = "ER";
+    elements.insert_before(second_index, "HS", 3);
+    elements.insert_before(first_index, "ZZ", 0);
+
+    for (const auto& elem : elements.forward(first_index)) {
+        printf ("HALP WHAT IS THIS?! %d, %s\n", elem.operating_number, elem.prefix);
+    }
+
+    for (const auto& elem : elements.backward(second_index)) {
+        printf("OH NO GOING BACKWARDS! %d, %s\n", elem.operating_number, elem.prefix);
+    }
+
     auto original = 100;
     auto& original_ref = original;
     printf("Original: %d\n", original);
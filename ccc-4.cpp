@@ -1,8 +1,18 @@
 #include <cstdio>
 #include <string>
 #include <cstring>
+#include <string_view>
+#include <concepts>
 #include <ctime>
+#include <chrono>
 #include <stdexcept>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -30,48 +40,69 @@
     the lifetime of an object is bound to the scope of a variable, i.e. what is created must be destroyed.
     Destructors that explicitly delete heap resources are a means of enforcing this.
 */
+/*
+    Small-Buffer Optimization: SimpleString keeps short strings (up to inline_capacity - 1 characters) in a buffer
+    that lives inside the object itself, so constructing or copying them never touches the free store.
+    Longer strings move to a heap buffer that grows geometrically (doubling), so appending never fails.
+
+    Moved-from state: buffer == nullptr, length == 0, max_size == 0. Such a string may only be assigned to,
+    appended to (which gives it a fresh buffer) or destroyed.
+*/
 struct SimpleString {
+    static const size_t inline_capacity { 24 }; // 23 characters + null terminator
+
     SimpleString(size_t max_size) 
-        : max_size{ max_size },
+        : max_size{ max_size < inline_capacity ? inline_capacity : max_size },
           length {} {
         if (max_size == 0) {
             throw std::runtime_error { "Max size must be at least 1." };
         }
 
-        buffer = new char[max_size];
+        buffer = this->max_size == inline_capacity ? inline_buffer : new char[this->max_size];
         buffer[0] = 0;
     }
 
-    // Copy Constructor
+    // Copy Constructor; only needs room for what other actually holds, and memcpy's the known length
+    // instead of having strcpy rescan for the terminator
     SimpleString(const SimpleString& other)
-    : max_size{ other.max_size },
-      length{ other.length },
-      buffer{ new char[other.max_size] } {
-        strcpy(buffer, other.buffer);
+    : max_size{ fit(other.length) },
+      length{ other.length } {
+        buffer = max_size == inline_capacity ? inline_buffer : new char[max_size];
+        if (length) std::memcpy(buffer, other.buffer, length);
+        buffer[length] = 0;
     }
 
     // Move Constructor; because other is an explicit rvalue, we can cannibalize it
     // Because it's designed not to throw an exception, it's marked noexcept
     // **** MOVING IS WAY LESS EXPENSIVE THAN COPYING BECAUSE RESOURCES ARE SAVED ***
+    // (except for inline strings: their characters live inside other, so those get copied over)
     SimpleString(SimpleString&& other) noexcept
     : max_size{ other.max_size },
       length{ other.length},
       buffer { other.buffer } {
+        if (other.is_inline()) {
+            std::memcpy(inline_buffer, other.inline_buffer, length + 1);
+            buffer = inline_buffer;
+        }
         other.length = 0;
         other.buffer = nullptr;
         other.max_size = 0;
     }
 
-    // Copy Assignment Operator
+    // Copy Assignment Operator; reuses the current buffer when other fits in it
     SimpleString& operator=(const SimpleString& other) {
         if (this == &other) return *this;
 
-        const auto new_buffer = new char[other.max_size];
-        delete[] buffer;
-        buffer = new_buffer;
+        if (!buffer || other.length >= max_size) {
+            const auto new_max_size = fit(other.length);
+            const auto new_buffer = new_max_size == inline_capacity ? inline_buffer : new char[new_max_size];
+            release();
+            buffer = new_buffer;
+            max_size = new_max_size;
+        }
         length = other.length;
-        max_size = other.max_size;
-        strcpy(buffer, other.buffer);
+        if (length) std::memcpy(buffer, other.buffer, length);
+        buffer[length] = 0;
         return *this;
     }
 
@@ -79,10 +110,14 @@ struct SimpleString {
     SimpleString& operator=(SimpleString&& other) noexcept{
         if (this == &other) return *this;
 
-        delete[] buffer;
+        release();
         buffer = other.buffer;
         length = other.length;
         max_size = other.max_size;
+        if (other.is_inline()) {
+            std::memcpy(inline_buffer, other.inline_buffer, length + 1);
+            buffer = inline_buffer;
+        }
         other.buffer = nullptr;
         other.length = 0;
         other.max_size = 0;
@@ -91,32 +126,123 @@ struct SimpleString {
     }
 
     ~SimpleString() {
-        delete[] buffer;
+        release();
     }
 
     void print(const char* tag) const {
         printf("%s: %s\n", tag, buffer);
     }
 
+    // Makes sure the buffer can hold new_max_size characters including the null terminator
+    void reserve(size_t new_max_size) {
+        if (buffer && new_max_size <= max_size) return;
+        if (!buffer && new_max_size <= inline_capacity) {
+            buffer = inline_buffer;
+            max_size = inline_capacity;
+            buffer[0] = 0;
+            return;
+        }
+
+        const auto new_buffer = new char[new_max_size];
+        if (buffer) {
+            std::memcpy(new_buffer, buffer, length + 1);
+        } else {
+            new_buffer[0] = 0;
+        }
+        release();
+        buffer = new_buffer;
+        max_size = new_max_size;
+    }
+
+    // Appends without a trailing newline. string_view carries its own length, so nothing gets rescanned or copied
+    // into a temporary first.
+    void append(std::string_view appendee) {
+        grow_for(appendee.size());
+        std::memcpy(buffer + length, appendee.data(), appendee.size());
+        length += appendee.size();
+        buffer[length] = 0;
+    }
+
+    // Always succeeds now that the buffer grows; the bool is kept for existing callers.
     bool append_line(const char* appendee) {
         const auto appendee_len = strlen(appendee);
-        if (appendee_len + length + 2 > max_size) {
-            return false;
-        } else {
-            // Buffer + length == next spot in buffer to place string
-            // max_size - length makes sure that insertion doesn't exceed buffer length
-            std::strncpy(buffer + length, appendee, max_size - length);
-            length += appendee_len; // update length
-            buffer[length++] = '\n'; // add newline
-            buffer[length] = 0; // null terminate
-            return true;
+        grow_for(appendee_len + 1);
+        // Buffer + length == next spot in buffer to place string.
+        // memcpy copies exactly appendee_len bytes, where strncpy would zero-pad all the way to max_size
+        std::memcpy(buffer + length, appendee, appendee_len);
+        length += appendee_len; // update length
+        buffer[length++] = '\n'; // add newline
+        buffer[length] = 0; // null terminate
+        return true;
+    }
+
+    /*
+        Bulk append: adds every piece as its own line. The total length is computed up front, so the buffer is
+        reserved once and each piece is copied exactly once, instead of growing and rescanning per append_line.
+        Accepts anything convertible to std::string_view, e.g. string.append_lines("Galactica!", some_std_string);
+    */
+    template<typename... Lines>
+        requires (std::convertible_to<const Lines&, std::string_view> && ...)
+    void append_lines(const Lines&... lines) {
+        const std::string_view views[] { std::string_view{ lines }... };
+        append_lines(views, sizeof...(lines));
+    }
+
+    // Same as above for a runtime number of lines
+    void append_lines(const std::string_view* lines, size_t n_lines) {
+        size_t total { n_lines }; // one newline per line
+        for (size_t i{}; i < n_lines; i++) {
+            total += lines[i].size();
         }
+        grow_for(total);
+
+        auto cursor = buffer + length;
+        for (size_t i{}; i < n_lines; i++) {
+            std::memcpy(cursor, lines[i].data(), lines[i].size());
+            cursor += lines[i].size();
+            *cursor++ = '\n';
+        }
+        length += total;
+        buffer[length] = 0;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    size_t capacity() const {
+        return max_size;
+    }
+
+    const char* c_str() const {
+        return buffer;
     }
 
     private:
+        // Capacity for a string of the given length: inline if it fits, otherwise exactly enough
+        static size_t fit(size_t length) {
+            return length < inline_capacity ? inline_capacity : length + 1;
+        }
+
+        bool is_inline() const {
+            return buffer == inline_buffer;
+        }
+
+        void release() {
+            if (!is_inline()) delete[] buffer;
+        }
+
+        // Geometric growth: doubling keeps n appends at O(n) total copying instead of O(n^2)
+        void grow_for(size_t extra) {
+            const auto needed = length + extra + 1;
+            if (buffer && needed <= max_size) return;
+            reserve(needed > 2 * max_size ? needed : 2 * max_size);
+        }
+
         size_t max_size;
         char* buffer;
         size_t length;
+        char inline_buffer[inline_capacity];
 };
 
 struct SimpleStringOwner {
@@ -215,6 +341,204 @@ struct TimerClass {
     std::string *name;
 };
 
+/*
+    Scoped-zone profiler: TimerClass's idea - an object's lifetime is the thing being measured - made cheap enough
+    to leave in hot code.
+        - steady_clock timestamps in nanoseconds instead of time(NULL)'s whole seconds
+        - PROFILE_ZONE("name") only accepts a string literal. It goes into a static ZoneSite per call site, and
+          zones refer to that by pointer: nothing is allocated or copied per zone
+        - the destructor doesn't printf. It appends {site, start, end} to its thread's buffer; each buffer has a
+          single writer, so recording is a plain store plus a release store of the count, with no lock.
+          A thread registers its buffer once; when a buffer is full, later events are counted as dropped
+        - Profiler::summary() aggregates count, total, p50 and p99 per zone; write_chrome_trace() exports the events
+          as Chrome trace JSON for chrome://tracing or ui.perfetto.dev
+        - build with -DCCC_PROFILE=0 and PROFILE_ZONE expands to nothing
+*/
+#ifndef CCC_PROFILE
+#define CCC_PROFILE 1
+#endif
+
+namespace profiler {
+
+struct ZoneSite {
+    const char* name;
+    const char* file;
+    int line;
+};
+
+struct Event {
+    const ZoneSite* site;
+    int64_t start_ns, end_ns;
+};
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Written only by its own thread; readers see the first size() events
+class ThreadBuffer {
+public:
+    static const size_t capacity { 1 << 16 };
+
+    explicit ThreadBuffer(uint32_t thread_id) : thread_id{ thread_id }, events{ new Event[capacity] } { }
+
+    void record(const ZoneSite* site, int64_t start_ns, int64_t end_ns) {
+        const auto n = count.load(std::memory_order_relaxed);
+        if (n == capacity) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        events[n] = { site, start_ns, end_ns };
+        count.store(n + 1, std::memory_order_release);  // publishes the event to readers
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    size_t dropped_events() const { return dropped.load(std::memory_order_relaxed); }
+    const Event& operator[](size_t i) const { return events[i]; }
+    // Only while no zones are open on this buffer's thread
+    void clear() { count.store(0); dropped.store(0); }
+
+    const uint32_t thread_id;
+
+private:
+    std::atomic<size_t> count{}, dropped{};
+    std::unique_ptr<Event[]> events;
+};
+
+struct ZoneStats {
+    const char* name;
+    size_t count;
+    int64_t total_ns, p50_ns, p99_ns, max_ns;
+};
+
+class Profiler {
+public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    // Buffers outlive their threads, so events from finished threads can still be reported
+    ThreadBuffer& thread_buffer() {
+        thread_local ThreadBuffer* buffer { register_thread() };
+        return *buffer;
+    }
+
+    // Zones sorted by total time, most expensive first
+    std::vector<ZoneStats> summary() const {
+        std::vector<std::pair<const ZoneSite*, int64_t>> durations;
+        for_each_event([&](uint32_t, const Event& event) { durations.emplace_back(event.site, event.end_ns - event.start_ns); });
+        std::sort(durations.begin(), durations.end());  // groups by site, then by duration
+
+        std::vector<ZoneStats> stats;
+        for (size_t first{}; first < durations.size(); ) {
+            auto last = first;
+            int64_t total{};
+            while (last < durations.size() && durations[last].first == durations[first].first) {
+                total += durations[last++].second;
+            }
+            const auto n = last - first;
+            stats.push_back({ durations[first].first->name, n, total, durations[first + n / 2].second,
+                              durations[first + std::min(n - 1, n * 99 / 100)].second, durations[last - 1].second });
+            first = last;
+        }
+        std::sort(stats.begin(), stats.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.total_ns > b.total_ns; });
+        return stats;
+    }
+
+    void print_summary() const {
+        printf("%-24s %10s %12s %10s %10s %10s\n", "zone", "count", "total us", "p50 ns", "p99 ns", "max ns");
+        for (const auto& zone : summary()) {
+            printf("%-24s %10zu %12.1f %10lld %10lld %10lld\n", zone.name, zone.count, zone.total_ns / 1e3,
+                   static_cast<long long>(zone.p50_ns), static_cast<long long>(zone.p99_ns), static_cast<long long>(zone.max_ns));
+        }
+        if (const auto dropped = dropped_events()) {
+            printf("(%zu events dropped: thread buffers were full)\n", dropped);
+        }
+    }
+
+    // Chrome trace event format: one complete ("X") event per zone, timestamps in microseconds
+    bool write_chrome_trace(const char* path) const {
+        const auto file = fopen(path, "w");
+        if (!file) return false;
+        int64_t origin { INT64_MAX };
+        for_each_event([&](uint32_t, const Event& event) { origin = std::min(origin, event.start_ns); });
+        fputs("{\"traceEvents\":[", file);
+        bool first { true };
+        for_each_event([&](uint32_t thread_id, const Event& event) {
+            fprintf(file, "%s\n{\"name\":\"", first ? "" : ",");
+            for (auto c = event.site->name; *c; c++) {
+                if (*c == '"' || *c == '\\') fputc('\\', file);
+                fputc(*c, file);
+            }
+            fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", thread_id,
+                    (event.start_ns - origin) / 1e3, (event.end_ns - event.start_ns) / 1e3);
+            first = false;
+        });
+        fputs("\n],\"displayTimeUnit\":\"ns\"}\n", file);
+        return fclose(file) == 0;
+    }
+
+    size_t dropped_events() const {
+        std::lock_guard<std::mutex> guard{ lock };
+        size_t dropped{};
+        for (const auto& buffer : buffers) dropped += buffer->dropped_events();
+        return dropped;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> guard{ lock };
+        for (const auto& buffer : buffers) buffer->clear();
+    }
+
+private:
+    ThreadBuffer* register_thread() {
+        std::lock_guard<std::mutex> guard{ lock };
+        buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<uint32_t>(buffers.size() + 1)));
+        return buffers.back().get();
+    }
+
+    template <typename Fn>
+    void for_each_event(Fn&& fn) const {
+        std::lock_guard<std::mutex> guard{ lock };
+        for (const auto& buffer : buffers) {
+            const auto n = buffer->size();
+            for (size_t i{}; i < n; i++) fn(buffer->thread_id, (*buffer)[i]);
+        }
+    }
+
+    mutable std::mutex lock;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+class ScopedZone {
+public:
+    explicit ScopedZone(const ZoneSite& site)
+        : site{ &site }, buffer{ Profiler::instance().thread_buffer() }, start_ns{ now_ns() } { }
+    ~ScopedZone() { buffer.record(site, start_ns, now_ns()); }
+
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+    const ZoneSite* site;
+    ThreadBuffer& buffer;
+    int64_t start_ns;
+};
+
+} // namespace profiler
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#if CCC_PROFILE
+// "" name "" only compiles for a string literal
+#define PROFILE_ZONE(name) \
+    static constexpr profiler::ZoneSite PROFILE_CONCAT(profile_site_, __LINE__) { "" name "", __FILE__, __LINE__ }; \
+    const profiler::ScopedZone PROFILE_CONCAT(profile_zone_, __LINE__) { PROFILE_CONCAT(profile_site_, __LINE__) }
+#else
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#endif
+
 void fn_c() {
     SimpleStringOwner c{ "cccccccccccccc" };
 }
@@ -230,6 +554,64 @@ void foo(SimpleString x) {
     x.append_line("This change is lost");
 }
 
+// Compares n_lines append_line calls with a single append_lines call building the same string
+void benchmark_appends(size_t n_lines) {
+    const char* line { "Starbuck. Whaddya hear?" };
+    const auto views = new std::string_view[n_lines];
+    for (size_t i{}; i < n_lines; i++) {
+        views[i] = line;
+    }
+
+    const auto single_start = std::chrono::steady_clock::now();
+    SimpleString singles{ 1 };
+    for (size_t i{}; i < n_lines; i++) {
+        singles.append_line(line);
+    }
+    const auto bulk_start = std::chrono::steady_clock::now();
+    SimpleString bulk{ 1 };
+    bulk.append_lines(views, n_lines);
+    const auto bulk_end = std::chrono::steady_clock::now();
+
+    using micros = std::chrono::duration<double, std::micro>;
+    printf("%zu append_line calls: %.1f us\n", n_lines, micros(bulk_start - single_start).count());
+    printf("1 append_lines call:    %.1f us (same result: %s)\n", micros(bulk_end - bulk_start).count(),
+        strcmp(singles.c_str(), bulk.c_str()) == 0 ? "yes" : "no");
+    delete[] views;
+}
+
+// Two threads building strings under nested zones, plus the cost of an empty zone
+void profile_demo(const char* trace_path) {
+    auto work = [] {
+        PROFILE_ZONE("worker");
+        for (int i{}; i < 200; i++) {
+            PROFILE_ZONE("build string");
+            SimpleString string{ 1 };
+            for (int j{}; j < 100; j++) {
+                string.append_line("Starbuck. Whaddya hear?");
+            }
+            PROFILE_ZONE("copy string");
+            SimpleString copy{ string };
+        }
+    };
+    std::thread first{ work }, second{ work };
+    first.join();
+    second.join();
+
+    const int n_empty { 20'000 };
+    const auto start = std::chrono::steady_clock::now();
+    for (int i{}; i < n_empty; i++) {
+        PROFILE_ZONE("empty");
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("Empty zone: %.1f ns each\n", elapsed.count() / n_empty);
+
+    profiler::Profiler::instance().print_summary();
+    if (trace_path) {
+        printf(profiler::Profiler::instance().write_chrome_trace(trace_path) ? "Chrome trace written to %s\n"
+                                                                             : "Could not write %s\n", trace_path);
+    }
+}
+
 void ref_type(int& x) {
     printf("lvalue reference: %d\n", x);
 }
@@ -238,7 +620,8 @@ void ref_type(int&& x) {
     printf("rvalue reference: %d\n", x);
 }
 
-int main() {
+// Pass a path to also write the profiler's Chrome trace there
+int main(int argc, char** argv) {
     
 
     TimerClass t{"t"};
@@ -255,13 +638,20 @@ int main() {
     string.append_line("Grab ya gun and bring the cat in.");
     string.append_line("Aye-aye sir, coming home.");
     string.print("B: ");
+    // Used to fail once the 115 bytes ran out; now the buffer simply doubles
     if (!string.append_line("Galactica!")) {
         printf("String was not big enough to append another message.\n");
     }
+    string.print("C: ");
+    string.append(std::string_view{ "So say we all.\n" });
+    string.print("D: ");
+    string.append_lines("Grab ya gun and bring the cat in.", "Aye-aye sir, coming home.");
+    string.print("E: ");
 
     SimpleStringOwner x { "x" };
     printf("x is alive!\n");
 
+    // SimpleString grows on demand now, so "cccccccccccccc" no longer overflows and nothing here throws
     try {
         SimpleStringOwner a{ "aaaaaa" };
         fn_b();
@@ -282,6 +672,9 @@ int main() {
     foo(empty_boi);
     a.print("Still empty");
 
+    benchmark_appends(10'000);
+    profile_demo(argc > 1 ? argv[1] : nullptr);
+
     auto b = 1;
     ref_type(b); // lvalue because named
     ref_type(std::move(b)); //std::move doesn't actually move, just cast lvalue to rvalue
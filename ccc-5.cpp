@@ -1,13 +1,59 @@
 #include <cstdio>
+#include <cerrno>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <mutex>
+#include <condition_variable>
+#include <concepts>
+#include <type_traits>
 
 // HEY! If you only have c headers included, you need to include this to get all the goodies
 #ifdef _WIN32
 #include <Windows.h>
+#include <io.h>
 #else
 #include <unistd.h>
 #endif
 
+struct Transfer {
+  long from;
+  long to;
+  double amount;
+};
+
+// Formats a whole batch into one stack buffer and writes it with as few stdio calls as possible
+void print_transfers(const char* tag, std::span<const Transfer> batch) {
+  char buffer[4096];
+  size_t used{};
+  for (const auto& t : batch) {
+    if (used > sizeof(buffer) - 128) {
+      fwrite(buffer, 1, used, stdout);
+      used = 0;
+    }
+    const auto room = sizeof(buffer) - used;
+    const auto written = snprintf(buffer + used, room, "%s %ld -> %ld: %f\n", tag, t.from, t.to, t.amount);
+    if (written < 0) {
+      continue;
+    }
+    if (static_cast<size_t>(written) >= room) {
+      // a line longer than what's left (a long tag, or %f of a huge amount): flush and print it directly
+      fwrite(buffer, 1, used, stdout);
+      used = 0;
+      printf("%s %ld -> %ld: %f\n", tag, t.from, t.to, t.amount);
+      continue;
+    }
+    used += static_cast<size_t>(written);
+  }
+  fwrite(buffer, 1, used, stdout);
+}
+
 struct Logger {
   virtual ~Logger() = default;
   // pure virtual function: any function definition beginning in 'virtual' and ending in '=0'
@@ -15,26 +61,183 @@ struct Logger {
   // a struct/class containing only pure virtual functions is considered an interface
   virtual void print_type() = 0;
   virtual void log_transfer(long from, long to, double amount) = 0;
+  // Batch version: one virtual call for the whole batch. Loggers that can write it in one go should override this.
+  virtual void log_transfers(std::span<const Transfer> batch) {
+    for (const auto& t : batch) {
+      log_transfer(t.from, t.to, t.amount);
+    }
+  }
   virtual void error(const char* message) {
     printf("ERROR %s\n", message);
   }
 };
 
-struct FileLogger : Logger {
+/*
+  FileLogger: appends every transfer to disk as a fixed-size binary LogRecord instead of formatting text.
+    - Records are gathered in a large in-memory block and written with one fwrite per block.
+    - The log is split into segments, <prefix>.000000.log, <prefix>.000001.log, ...; a new one starts once the
+      current segment reaches segment_bytes.
+    - FsyncPolicy decides how durable that is: Never leaves it to the OS, OnRotate syncs each finished segment,
+      EveryBlock syncs after every block write.
+    - Segments are never overwritten: they are created exclusively, skipping indices a previous run already used.
+      segment_paths() lists the ones this logger wrote.
+    - If a segment can't be opened or a write comes up short, error() reports it and the rest of the block is
+      dropped (counted in dropped_records()); a short write also closes the segment so records never follow a torn one.
+    - Not thread-safe on its own: wrap it in an AsyncLogger when several threads log.
+  Use ccc-5_log_reader to turn segments back into text.
+*/
+struct LogRecord {
+  int64_t from;
+  int64_t to;
+  double amount;
+  int64_t timestamp_ns; // system_clock, since the epoch
+};
+
+enum class FsyncPolicy { Never, OnRotate, EveryBlock };
+
+struct FileLogger final : Logger {
+  static constexpr char segment_magic[8] { 'C', 'C', 'C', 'L', 'O', 'G', '1', 0 };
+
+  FileLogger(const char* path_prefix = "transfers",
+             size_t segment_bytes = 64 * 1024 * 1024,
+             FsyncPolicy fsync_policy = FsyncPolicy::OnRotate,
+             size_t block_bytes = 1024 * 1024)
+  : m_prefix { path_prefix },
+    m_segmentBytes { segment_bytes },
+    m_fsyncPolicy { fsync_policy },
+    m_blockRecords { std::max<size_t>(block_bytes / sizeof(LogRecord), 1) },
+    m_block { new LogRecord[m_blockRecords] } {}
+
+  FileLogger(const FileLogger&) = delete;
+  FileLogger& operator=(const FileLogger&) = delete;
+
+  ~FileLogger() override {
+    flush();
+    close_segment();
+    delete[] m_block;
+  }
+
   void print_type() override {
     printf("FILE LOGGER\n");
   }
 
   void log_transfer(long from, long to, double amount) override {
-    printf("[file] %ld -> %ld: %f\n", from, to, amount);
+    if (m_used == m_blockRecords) flush();
+    m_block[m_used++] = LogRecord { from, to, amount, now_ns() };
+  }
+
+  // One clock read for the whole batch
+  void log_transfers(std::span<const Transfer> batch) override {
+    const auto timestamp = now_ns();
+    for (const auto& t : batch) {
+      if (m_used == m_blockRecords) flush();
+      m_block[m_used++] = LogRecord { t.from, t.to, t.amount, timestamp };
+    }
   }
 
   void error(const char* message) override {
     printf("[file] ERROR %s\n", message);
   }
+
+  // Writes the current block out, rotating segments if it would overflow the current one
+  void flush() {
+    size_t done{};
+    while (done < m_used) {
+      if (!m_file || m_segmentUsed + sizeof(LogRecord) > m_segmentBytes) open_next_segment();
+      if (!m_file) break;
+
+      const auto room = std::max<size_t>((m_segmentBytes - m_segmentUsed) / sizeof(LogRecord), 1);
+      const auto n = std::min(room, m_used - done);
+      const auto written = fwrite(m_block + done, sizeof(LogRecord), n, m_file);
+      m_segmentUsed += written * sizeof(LogRecord);
+      done += written;
+      if (written != n) {
+        error("Short write to log segment");
+        close_segment();
+        break;
+      }
+    }
+    m_dropped += m_used - done;
+    m_used = 0;
+    if (m_file && m_fsyncPolicy == FsyncPolicy::EveryBlock) sync();
+  }
+
+  size_t segment_count() const {
+    return m_paths.size();
+  }
+
+  const std::vector<std::string>& segment_paths() const {
+    return m_paths;
+  }
+
+  size_t dropped_records() const {
+    return m_dropped;
+  }
+
+  private:
+    std::string segment_path(size_t index) const {
+      char suffix[32];
+      snprintf(suffix, sizeof(suffix), ".%06zu.log", index);
+      return m_prefix + suffix;
+    }
+
+    static int64_t now_ns() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void open_next_segment() {
+      close_segment();
+      // "x": create only, fail if it exists, so an earlier run's segments are skipped instead of truncated
+      std::string path;
+      for (; m_nextIndex <= 999'999 && !m_file; m_nextIndex++) {
+        path = segment_path(m_nextIndex);
+        m_file = fopen(path.c_str(), "wbx");
+        if (!m_file && errno != EEXIST) break;
+      }
+      if (!m_file) {
+        error("Unable to open log segment");
+        return;
+      }
+      setvbuf(m_file, nullptr, _IONBF, 0); // we already write in large blocks; skip stdio's extra copy
+      m_paths.push_back(path);
+      if (fwrite(segment_magic, 1, sizeof(segment_magic), m_file) != sizeof(segment_magic)) {
+        error("Short write to log segment");
+        close_segment();
+        return;
+      }
+      m_segmentUsed = sizeof(segment_magic);
+    }
+
+    void close_segment() {
+      if (!m_file) return;
+      if (m_fsyncPolicy != FsyncPolicy::Never) sync();
+      fclose(m_file);
+      m_file = nullptr;
+    }
+
+    void sync() {
+#ifdef _WIN32
+      _commit(_fileno(m_file));
+#else
+      fsync(fileno(m_file));
+#endif
+    }
+
+    std::string m_prefix;
+    size_t m_segmentBytes;
+    FsyncPolicy m_fsyncPolicy;
+    size_t m_blockRecords;
+    LogRecord* m_block;
+    size_t m_used {};
+    FILE* m_file {};
+    size_t m_segmentUsed {};
+    size_t m_nextIndex {};
+    std::vector<std::string> m_paths;
+    size_t m_dropped {};
 };
 
-struct ConsoleLogger : Logger {
+struct ConsoleLogger final : Logger {
   void print_type() override {
     printf("CONSOLE LOGGER\n");
   }
@@ -42,21 +245,144 @@ struct ConsoleLogger : Logger {
   void log_transfer(long from, long to, double amount) override {
     printf("[console] %ld -> %ld: %f\n", from, to, amount);
   }
+
+  void log_transfers(std::span<const Transfer> batch) override {
+    print_transfers("[console]", batch);
+  }
   
   void error(const char* message) override {
     printf("[console] ERROR %s\n", message);
   }
 };
 
+/*
+  Asynchronous logging stage: log_transfer only copies the record into a ring buffer and returns. A background
+  thread drains the ring in batches into the wrapped logger (e.g. a FileLogger or ConsoleLogger), so the caller
+  never waits on stdout. When the ring is full, callers wait for the drain (backpressure) instead of dropping records.
+*/
+struct AsyncLogger final : Logger {
+  static const size_t ring_size { 4096 };
+
+  AsyncLogger(Logger& target)
+  : target { target },
+    drainer { [this] { drain(); } } {}
+
+  // Destruction stops the background thread, but only after everything queued has been written
+  ~AsyncLogger() override {
+    {
+      std::lock_guard<std::mutex> guard { lock };
+      stopping = true;
+    }
+    not_empty.notify_one();
+    drainer.join();
+  }
+
+  void print_type() override {
+    printf("ASYNC ");
+    target.print_type();
+  }
+
+  void log_transfer(long from, long to, double amount) override {
+    const Transfer t { from, to, amount };
+    log_transfers(std::span<const Transfer>{ &t, 1 });
+  }
+
+  // Queues as much as fits and wakes the drainer before waiting for room, so a batch bigger than the ring can't
+  // end up waiting on a drainer that was never told there is work
+  void log_transfers(std::span<const Transfer> batch) override {
+    std::unique_lock<std::mutex> guard { lock };
+    size_t done{};
+    while (done < batch.size()) {
+      not_full.wait(guard, [this] { return tail - head < ring_size; });
+      while (done < batch.size() && tail - head < ring_size) {
+        ring[tail++ % ring_size] = batch[done++];
+      }
+      not_empty.notify_one();
+    }
+  }
+
+  void error(const char* message) override {
+    flush(); // keep errors in order with the transfers queued before them
+    target.error(message);
+  }
+
+  // Blocks until every record queued so far has been handed to the target logger
+  void flush() {
+    std::unique_lock<std::mutex> guard { lock };
+    drained.wait(guard, [this] { return written == tail; });
+  }
+
+  private:
+    void drain() {
+      Transfer batch[256];
+      std::unique_lock<std::mutex> guard { lock };
+      while (true) {
+        not_empty.wait(guard, [this] { return stopping || head != tail; });
+        if (head == tail) return; // stopping and nothing left
+
+        // Copy out a contiguous run, then log it without holding the lock
+        size_t n{};
+        while (head != tail && n < std::size(batch)) {
+          batch[n++] = ring[head++ % ring_size];
+        }
+        guard.unlock();
+        not_full.notify_all();
+        target.log_transfers(std::span<const Transfer>{ batch, n });
+        fflush(stdout);
+        guard.lock();
+        written += n;
+        drained.notify_all();
+      }
+    }
+
+    Logger& target;
+    Transfer ring[ring_size];
+    size_t head {}; // next record to drain
+    size_t tail {}; // next free slot
+    size_t written {}; // records the target has finished logging
+    bool stopping {};
+    std::mutex lock;
+    std::condition_variable not_empty, not_full, drained;
+    std::thread drainer; // declared last so it starts after everything it uses is constructed
+};
+
+// Swallows everything. Used through its own type (e.g. in a BasicBank), every call inlines to nothing.
+struct NullLogger final : Logger {
+  void print_type() override {
+    printf("NULL LOGGER\n");
+  }
+
+  void log_transfer(long, long, double) override {}
+  void log_transfers(std::span<const Transfer>) override {}
+  void error(const char*) override {}
+};
+
 struct AccountDatabase {
   virtual ~AccountDatabase() = default;
 
   virtual long getAmount(long id) = 0;
   virtual void setAmount(long id, long amount) = 0;
   virtual long registerAccount(long id) = 0;
+
+  // Read-modify-write helpers. The defaults are plain get/set, which is fine for single-threaded databases;
+  // concurrent databases override them with atomic versions.
+  virtual long deposit(long id, long amount) {
+    const long new_amount = getAmount(id) + amount;
+    setAmount(id, new_amount);
+    return new_amount;
+  }
+
+  virtual long withdraw(long id, long amount) {
+    return deposit(id, -amount);
+  }
+
+  virtual void transfer(long from, long to, long amount) {
+    withdraw(from, amount);
+    deposit(to, amount);
+  }
 };
 
-struct InMemoryAccountDatabase : AccountDatabase {
+struct InMemoryAccountDatabase final : AccountDatabase {
   InMemoryAccountDatabase(size_t num_accounts, Logger& logger) 
   : m_maxAccounts { num_accounts },
     m_numAccounts { 0 },
@@ -89,6 +415,20 @@ struct InMemoryAccountDatabase : AccountDatabase {
     m_accounts[id] = amount;
   }
 
+  // Direct array updates, so a caller that knows the concrete type can inline the whole thing
+  long deposit(long id, long amount) override {
+    return m_accounts[id] += amount;
+  }
+
+  long withdraw(long id, long amount) override {
+    return m_accounts[id] -= amount;
+  }
+
+  void transfer(long from, long to, long amount) override {
+    m_accounts[from] -= amount;
+    m_accounts[to] += amount;
+  }
+
   private:
     size_t m_maxAccounts;
     size_t m_numAccounts;
@@ -96,6 +436,89 @@ struct InMemoryAccountDatabase : AccountDatabase {
     Logger *m_logger;
 };
 
+/*
+  Concurrent, lock-free-on-the-common-path account database.
+    - Every balance sits in its own 64-byte cache line (alignas), so threads hammering neighbouring accounts
+      don't keep stealing the same line from each other (false sharing).
+    - Deposits and withdrawals are a single atomic fetch_add: no lock, no lost updates.
+    - A transfer has to move money out of one account and into another without anyone seeing only half of it
+      happen to a pair of accounts, so it takes a tiny per-account spinlock on both. Locks are always taken
+      lowest id first: two transfers going opposite ways between the same accounts can't deadlock.
+*/
+struct ConcurrentAccountDatabase final : AccountDatabase {
+  ConcurrentAccountDatabase(size_t num_accounts, Logger& logger)
+  : m_maxAccounts { num_accounts },
+    m_numAccounts { 0 },
+    m_accounts { new Account[m_maxAccounts] },
+    m_logger { &logger } {}
+
+  ~ConcurrentAccountDatabase() override {
+    delete[] m_accounts;
+  }
+
+  long registerAccount([[maybe_unused]] long id) override {
+    const auto index = m_numAccounts.fetch_add(1);
+    if (index >= m_maxAccounts) {
+      m_numAccounts--;
+      (*m_logger).error("Unable to register any more accounts");
+      return -1;
+    }
+    m_accounts[index].amount.store(0);
+    return (long) index;
+  }
+
+  long getAmount(long id) override {
+    return m_accounts[id].amount.load(std::memory_order_relaxed);
+  }
+
+  void setAmount(long id, long amount) override {
+    m_accounts[id].amount.store(amount, std::memory_order_relaxed);
+  }
+
+  long deposit(long id, long amount) override {
+    return m_accounts[id].amount.fetch_add(amount, std::memory_order_relaxed) + amount;
+  }
+
+  long withdraw(long id, long amount) override {
+    return m_accounts[id].amount.fetch_sub(amount, std::memory_order_relaxed) - amount;
+  }
+
+  void transfer(long from, long to, long amount) override {
+    if (from == to) return;
+
+    auto& first = m_accounts[from < to ? from : to];
+    auto& second = m_accounts[from < to ? to : from];
+    first.lock();
+    second.lock();
+    m_accounts[from].amount.fetch_sub(amount, std::memory_order_relaxed);
+    m_accounts[to].amount.fetch_add(amount, std::memory_order_relaxed);
+    second.unlock();
+    first.unlock();
+  }
+
+  private:
+    struct alignas(64) Account {
+      std::atomic<long> amount {};
+      std::atomic<bool> locked {};
+
+      void lock() {
+        // Spin on a plain load so waiting threads share the line instead of bouncing it with writes
+        while (locked.exchange(true, std::memory_order_acquire)) {
+          while (locked.load(std::memory_order_relaxed)) std::this_thread::yield();
+        }
+      }
+
+      void unlock() {
+        locked.store(false, std::memory_order_release);
+      }
+    };
+
+    size_t m_maxAccounts;
+    std::atomic<size_t> m_numAccounts;
+    Account* m_accounts;
+    Logger *m_logger;
+};
+
 struct Bank {
   // Using a reference because pass-by-value isn't allowed with interfaces
   Bank(Logger& logger, AccountDatabase& acctDB) 
@@ -121,29 +544,48 @@ struct Bank {
       printf("AMNT IN FROM: %ld\n", acctDB.getAmount(from));
       printf("AMNT in TO: %ld\n", acctDB.getAmount(to));
 
-      make_withdrawl(from, amount);
-      make_deposit(to, amount);
+      acctDB.transfer(from, to, amount);
 
       printf("AMNT IN FROM POST-TRANSFER: %ld\n", acctDB.getAmount(from));
       printf("AMNT in TO POST_TRANSFER: %ld\n", acctDB.getAmount(to));
     } else {
-      make_withdrawl(from, amount);
-      make_deposit(to, amount);
+      acctDB.transfer(from, to, amount);
     }
   }
 
-  long make_deposit(long id, long deposit) {
-    long new_amount = acctDB.getAmount(id) + deposit;
-    acctDB.setAmount(id, new_amount);
+  /*
+    Applies a whole batch of transfers. Debits and credits are first merged per account, so an account that shows
+    up in many transfers is touched once with its net change. The log records go to the logger in a single call.
+    Note: the batch is applied as a set of net balance changes, so nothing observes the individual transfers in
+    between; like make_transfer, amounts are truncated to whole units.
+  */
+  void submit_batch(std::span<const Transfer> batch) {
+    std::vector<std::pair<long, long>> deltas; // (account id, change)
+    deltas.reserve(batch.size() * 2);
+    for (const auto& t : batch) {
+      deltas.emplace_back(t.from, -(long) t.amount);
+      deltas.emplace_back(t.to, (long) t.amount);
+    }
+    std::sort(deltas.begin(), deltas.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
 
-    return new_amount;
+    for (size_t i{}; i < deltas.size();) {
+      const auto id = deltas[i].first;
+      long net{};
+      for (; i < deltas.size() && deltas[i].first == id; i++) {
+        net += deltas[i].second;
+      }
+      if (net != 0) acctDB.deposit(id, net);
+    }
+
+    if (logger) (*logger).log_transfers(batch);
   }
 
-  long make_withdrawl(long id, long withdrawl) {
-    long new_amount = acctDB.getAmount(id) - withdrawl;
-    acctDB.setAmount(id, new_amount);
+  long make_deposit(long id, long deposit) {
+    return acctDB.deposit(id, deposit);
+  }
 
-    return new_amount;
+  long make_withdrawl(long id, long withdrawl) {
+    return acctDB.withdraw(id, withdrawl);
   }
 
   private:
@@ -152,6 +594,159 @@ struct Bank {
     AccountDatabase &acctDB;
 };
 
+/*
+  Compile-time binding: the same Bank, but the logger and database types are template parameters constrained by
+  concepts (the same idea as Integer in ccc-6.cpp). Every call below is a direct call on a concrete (final) type,
+  so the compiler can inline it. The price is that the logger can't be swapped at runtime; use Bank for that.
+*/
+template<typename T>
+concept TransferLogger = requires(T& logger, long id, double amount, const char* message) {
+  logger.log_transfer(id, id, amount);
+  logger.error(message);
+};
+
+template<typename T>
+concept AccountStore = requires(T& db, long id, long amount) {
+  { db.registerAccount(id) } -> std::convertible_to<long>;
+  { db.getAmount(id) } -> std::convertible_to<long>;
+  db.deposit(id, amount);
+  db.withdraw(id, amount);
+  db.transfer(id, id, amount);
+};
+
+template<TransferLogger LoggerT, AccountStore DbT>
+struct BasicBank {
+  BasicBank(LoggerT& logger, DbT& acctDB)
+  : logger { logger },
+    acctDB { acctDB } { }
+
+  void add_account(long id) {
+    acctDB.registerAccount(id);
+  }
+
+  void make_transfer(long from, long to, double amount) {
+    logger.log_transfer(from, to, amount);
+    acctDB.transfer(from, to, amount);
+  }
+
+  long make_deposit(long id, long deposit) {
+    return acctDB.deposit(id, deposit);
+  }
+
+  long make_withdrawl(long id, long withdrawl) {
+    return acctDB.withdraw(id, withdrawl);
+  }
+
+  private:
+    LoggerT& logger;
+    DbT& acctDB;
+};
+
+// Per-transfer cost of the runtime-polymorphic Bank versus the statically bound BasicBank
+template<typename BankT>
+double time_transfers(BankT& bank, size_t num_accounts, size_t n_transfers) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i{}; i < n_transfers; i++) {
+    bank.make_transfer(i % num_accounts, (i * 7 + 3) % num_accounts, 1.0);
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / n_transfers;
+}
+
+void benchmark_dispatch(size_t n_transfers) {
+  const size_t num_accounts { 1024 };
+  NullLogger null_logger{};
+  InMemoryAccountDatabase acctDB { num_accounts, null_logger };
+  for (size_t i{}; i < num_accounts; i++) {
+    acctDB.registerAccount((long) i);
+  }
+
+  // Hide the concrete types behind the interfaces, like a caller that only gets a Logger& and AccountDatabase&
+  Logger* volatile runtime_logger = &null_logger;
+  AccountDatabase* volatile runtime_db = &acctDB;
+  Bank bank { *runtime_logger, *runtime_db };
+  bank.set_logger(nullptr); // skip the debug printfs; the database calls stay virtual
+  const auto virtual_db = time_transfers(bank, num_accounts, n_transfers);
+
+  // Bank prints balances whenever a logger is set, so the logger dispatch is measured through BasicBank's
+  // interface instantiation: the same calls, but with the no-op logger behind a virtual Logger&
+  BasicBank<Logger, AccountDatabase> virtual_bank { *runtime_logger, *runtime_db };
+  const auto virtual_all = time_transfers(virtual_bank, num_accounts, n_transfers);
+
+  BasicBank<NullLogger, InMemoryAccountDatabase> basic_bank { null_logger, acctDB };
+  const auto static_all = time_transfers(basic_bank, num_accounts, n_transfers);
+
+  printf("Bank (virtual database): %.2f ns/transfer\n", virtual_db);
+  printf("BasicBank<Logger, AccountDatabase> (virtual NullLogger + database): %.2f ns/transfer\n", virtual_all);
+  printf("BasicBank<NullLogger, InMemoryAccountDatabase>: %.2f ns/transfer\n", static_all);
+  printf("(checksum %ld)\n", acctDB.getAmount(0));
+}
+
+/*
+  Throughput benchmark: 1, 2, 4, ... threads (ending on the core count) each push random transfers through a
+  logger-less Bank backed by a ConcurrentAccountDatabase. The total across all accounts must be unchanged at the end.
+*/
+void benchmark_concurrent_transfers(size_t transfers_per_thread,
+                                    size_t max_threads = std::thread::hardware_concurrency()) {
+  const size_t num_accounts { 1024 };
+  const long opening_balance { 1'000'000 };
+  max_threads = std::max<size_t>(max_threads, 1);
+
+  // powers of two, then the actual core count if it isn't one (6, 12, 24, ...)
+  for (size_t n_threads { 1 }; n_threads <= max_threads;
+       n_threads = n_threads == max_threads ? max_threads + 1 : std::min(n_threads * 2, max_threads)) {
+    ConsoleLogger console{};
+    ConcurrentAccountDatabase acctDB { num_accounts, console };
+    Bank bank { console, acctDB };
+    bank.set_logger(nullptr);
+    for (size_t i{}; i < num_accounts; i++) {
+      bank.add_account((long) i);
+      bank.make_deposit((long) i, opening_balance);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t{}; t < n_threads; t++) {
+      workers.emplace_back([&bank, t, transfers_per_thread] {
+        uint32_t state = 0x4c4347 + (uint32_t) t;
+        for (size_t i{}; i < transfers_per_thread; i++) {
+          state = state * 1664525 + 1013904223; // quick LCG so random numbers don't dominate the measurement
+          const long from = (state >> 8) % num_accounts;
+          const long to = (state >> 20) % num_accounts;
+          bank.make_transfer(from, to, 1 + (state & 0x3F));
+        }
+      });
+    }
+    for (auto& worker : workers) worker.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    long total{};
+    for (size_t i{}; i < num_accounts; i++) {
+      total += acctDB.getAmount((long) i);
+    }
+    printf("%zu thread(s): %.2f M transfers/sec, books %s\n", n_threads,
+      n_threads * transfers_per_thread / elapsed.count() / 1e6,
+      total == opening_balance * (long) num_accounts ? "balance" : "DO NOT BALANCE");
+  }
+}
+
+// Logs n transfers through a FileLogger and reports the sustained rate, then removes the segments again
+void benchmark_file_logger(size_t n_transfers) {
+  FileLogger file { "bench_transfers", 16 * 1024 * 1024, FsyncPolicy::Never };
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i{}; i < n_transfers; i++) {
+    file.log_transfer((long) i % 1024, (long) (i * 7) % 1024, 49.95);
+  }
+  file.flush();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  printf("FileLogger: %.2f M transfers/sec into %zu segment(s)\n",
+    n_transfers / elapsed.count() / 1e6, file.segment_count());
+  for (const auto& path : file.segment_paths()) {
+    std::remove(path.c_str());
+  }
+}
+
 int main() {
   ConsoleLogger console{};
   InMemoryAccountDatabase acctDB {3, console};
@@ -171,4 +766,48 @@ int main() {
   bank.make_transfer(3000, 2000, 75.00);
   bank.set_logger(&console);
   bank.make_transfer(4000, 3000, 46.52);
+
+  // Batched transfers with the console logger moved onto a background thread
+  {
+    AsyncLogger async_console { console };
+    ConcurrentAccountDatabase batchDB { 4, console };
+    Bank batch_bank { async_console, batchDB };
+    for (long id{}; id < 4; id++) {
+      batch_bank.add_account(id);
+      batch_bank.make_deposit(id, 1000);
+    }
+
+    const Transfer batch[] { { 0, 1, 10.00 }, { 1, 2, 5.00 }, { 0, 1, 3.00 }, { 3, 0, 20.00 } };
+    batch_bank.submit_batch(batch);
+    async_console.flush();
+    for (long id{}; id < 4; id++) {
+      printf("AMNT IN %ld POST-BATCH: %ld\n", id, batchDB.getAmount(id));
+    }
+  }
+
+  // A batch bigger than AsyncLogger's ring has to go through in several drains
+  {
+    struct CountingLogger final : Logger {
+      void print_type() override { printf("COUNTING LOGGER\n"); }
+      void log_transfer(long, long, double) override { count++; }
+      void log_transfers(std::span<const Transfer> batch) override { count += batch.size(); }
+      size_t count{};
+    } counter;
+    AsyncLogger async_counter { counter };
+    ConcurrentAccountDatabase batchDB { 2, console };
+    Bank batch_bank { async_counter, batchDB };
+    batch_bank.add_account(0);
+    batch_bank.add_account(1);
+    // one record first, so the drainer has gone idle (parked on not_empty) when the big batch arrives
+    async_counter.log_transfer(0, 1, 1.00);
+    async_counter.flush();
+    const std::vector<Transfer> big_batch(AsyncLogger::ring_size + 904, Transfer{ 0, 1, 1.00 });
+    batch_bank.submit_batch(big_batch);
+    async_counter.flush();
+    printf("AsyncLogger delivered %zu of %zu batched transfers\n", counter.count - 1, big_batch.size());
+  }
+
+  benchmark_concurrent_transfers(1'000'000);
+  benchmark_file_logger(4'000'000);
+  benchmark_dispatch(50'000'000);
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+/*
+    Log reader: decodes the binary segments written by FileLogger in ccc-5.cpp back into text.
+    usage: ccc-5_log_reader transfers.000000.log [transfers.000001.log ...]
+
+    The record layout below has to match LogRecord in ccc-5.cpp byte for byte.
+*/
+struct LogRecord {
+    int64_t from;
+    int64_t to;
+    double amount;
+    int64_t timestamp_ns;
+};
+
+constexpr char segment_magic[8] { 'C', 'C', 'C', 'L', 'O', 'G', '1', 0 };
+
+// Reads the segment in large blocks, same as it was written. Returns false if it isn't a transfer log.
+bool decode_segment(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return false;
+    }
+
+    char magic[sizeof(segment_magic)];
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, segment_magic, sizeof(magic)) != 0) {
+        fprintf(stderr, "%s is not a transfer log segment\n", path);
+        fclose(file);
+        return false;
+    }
+
+    static LogRecord block[32 * 1024];
+    size_t n_records{};
+    size_t n_read{};
+    while ((n_read = fread(block, sizeof(LogRecord), sizeof(block) / sizeof(LogRecord), file)) > 0) {
+        for (size_t i{}; i < n_read; i++) {
+            const auto& r = block[i];
+            const time_t seconds = r.timestamp_ns / 1'000'000'000;
+            char when[32];
+            strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", gmtime(&seconds));
+            printf("%s.%09lld [file] %lld -> %lld: %f\n", when, (long long) (r.timestamp_ns % 1'000'000'000),
+                (long long) r.from, (long long) r.to, r.amount);
+        }
+        n_records += n_read;
+    }
+
+    fprintf(stderr, "%s: %zu records\n", path, n_records);
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <segment.log> [segment.log ...]\n", argv[0]);
+        return 1;
+    }
+
+    int result {};
+    for (int i { 1 }; i < argc; i++) {
+        if (!decode_segment(argv[i])) result = 1;
+    }
+    return result;
+}
@@ -3,6 +3,11 @@
 #include <map>
 #include <set>
 #include <type_traits>
+#include <limits>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -20,16 +25,170 @@
 template<typename T>
 concept Integer = std::is_integral<T>::value;
 
+/*
+    mean: sums into a wider accumulator (64-bit for integers, double for float), so a large int array no longer
+    silently overflows before the division. Four independent partial sums break the loop-carried dependency,
+    which lets the compiler keep several SIMD lanes busy instead of waiting on one running total.
+*/
+template<typename T>
+using MeanAccumulator = std::conditional_t<std::is_floating_point_v<T>,
+    std::conditional_t<(sizeof(T) < sizeof(double)), double, T>,
+    std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>>;
+
 template<typename T>
-T mean(T* values, size_t length) {
-    T result{};
-    for(size_t i{}; i < length; i++) {
-        result += values[i];
+T mean(const T* values, size_t length) {
+    using Acc = MeanAccumulator<T>;
+    if (length == 0) return T{};
+
+    Acc partial[4] {};
+    size_t i{};
+    for (; i + 4 <= length; i += 4) {
+        partial[0] += values[i];
+        partial[1] += values[i + 1];
+        partial[2] += values[i + 2];
+        partial[3] += values[i + 3];
+    }
+    for (; i < length; i++) {
+        partial[0] += values[i];
     }
 
-    return result / length;
+    const Acc result = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    return static_cast<T>(result / static_cast<Acc>(length));
 }
 
+/*
+    Tracks the running mode while counting, so the maximum and any tie fall out of the same pass:
+    a value whose count overtakes the best becomes the new mode; a different value merely reaching the best
+    count means a tie (until someone overtakes it again).
+*/
+template<Integer T>
+struct ModeTracker {
+    T best_value {};
+    size_t best_count {};
+    bool tied {};
+
+    void saw(T value, size_t count) {
+        if (count > best_count) {
+            best_count = count;
+            best_value = value;
+            tied = false;
+        } else if (count == best_count) {
+            tied = true;
+        }
+    }
+};
+
+/*
+    Open-addressing flat hash map from value to count: keys and counts live in two contiguous arrays and
+    collisions probe to the next slot (linear probing), so a lookup is a hash and usually one cache line.
+    Fibonacci hashing (multiply by 2^64 / golden ratio, keep the top bits) spreads clustered telemetry values.
+*/
+template<Integer T>
+struct FlatCounter {
+    FlatCounter(size_t expected_distinct = 1024) {
+        resize(std::bit_ceil(std::max<size_t>(expected_distinct * 2, 16)));
+    }
+
+    ~FlatCounter() {
+        delete[] keys;
+        delete[] counts;
+    }
+
+    FlatCounter(const FlatCounter&) = delete;
+    FlatCounter& operator=(const FlatCounter&) = delete;
+
+    // Returns the count after incrementing
+    size_t increment(T key) {
+        if (2 * (size + 1) > capacity) resize(capacity * 2); // keep load factor <= 1/2
+        size_t slot = hash(key);
+        while (counts[slot] && keys[slot] != key) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (!counts[slot]) {
+            keys[slot] = key;
+            size++;
+        }
+        return ++counts[slot];
+    }
+
+    private:
+    size_t hash(T key) const {
+        return (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> shift;
+    }
+
+    void resize(size_t new_capacity) {
+        const auto old_keys = keys;
+        const auto old_counts = counts;
+        const auto old_capacity = capacity;
+
+        keys = new T[new_capacity];
+        counts = new size_t[new_capacity] {};
+        capacity = new_capacity;
+        shift = 64 - std::countr_zero(new_capacity);
+        size = 0;
+        for (size_t i{}; i < old_capacity; i++) {
+            if (!old_counts[i]) continue;
+            size_t slot = hash(old_keys[i]);
+            while (counts[slot]) slot = (slot + 1) & (capacity - 1);
+            keys[slot] = old_keys[i];
+            counts[slot] = old_counts[i];
+            size++;
+        }
+        delete[] old_keys;
+        delete[] old_counts;
+    }
+
+    T* keys {};
+    size_t* counts {};
+    size_t capacity {};
+    size_t size {};
+    int shift {};
+};
+
+template<Integer T>
+T mode(const T* values, size_t length);
+
+/*
+    mode when the value range is known and small: a plain counting array indexed by value - min_value,
+    no hashing at all. The bounds are only trusted after one (vectorizable) pass checks every value against them;
+    if any value falls outside [min_value, max_value] this falls back to the general mode below. The range is
+    computed in uint64_t, so wide signed ranges can't overflow.
+*/
+template<Integer T>
+T mode(const T* values, size_t length, T min_value, T max_value) {
+    if (length <= 0) {
+        printf("NO VALUES GIVEN\n");
+        return 0;
+    }
+
+    bool bounded = min_value <= max_value;
+    for (size_t i = 0; i < length; i++) {
+        bounded &= values[i] >= min_value && values[i] <= max_value;
+    }
+    const auto span = static_cast<uint64_t>(max_value) - static_cast<uint64_t>(min_value);
+    if (!bounded || span >= std::numeric_limits<size_t>::max()) {
+        return mode(values, length);
+    }
+
+    const auto range = static_cast<size_t>(span) + 1;
+    const auto counts = new uint32_t[range] {};
+    ModeTracker<T> tracker;
+    for (size_t i = 0; i < length; i++) {
+        tracker.saw(values[i], ++counts[static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(min_value)]);
+    }
+    delete[] counts;
+
+    if (tracker.tied) {
+        printf("TOO MANY MODES\n");
+        return 0;
+    }
+    return tracker.best_value;
+}
+
+/*
+    mode for unknown ranges: one (vectorizable) min/max pass decides whether a counting array fits in a few
+    counters per element; otherwise count in the flat hash map.
+*/
 template<Integer T>
 T mode(const T* values, size_t length) {
     if (length <= 0) {
@@ -37,6 +196,37 @@ T mode(const T* values, size_t length) {
         return 0;
     }
 
+    T min_value = values[0], max_value = values[0];
+    for (size_t i = 1; i < length; i++) {
+        min_value = values[i] < min_value ? values[i] : min_value;
+        max_value = values[i] > max_value ? values[i] : max_value;
+    }
+    const auto range = static_cast<uint64_t>(max_value) - static_cast<uint64_t>(min_value);
+    if (range < 4 * static_cast<uint64_t>(length) + 1024) {
+        return mode(values, length, min_value, max_value);
+    }
+
+    FlatCounter<T> counter;
+    ModeTracker<T> tracker;
+    for (size_t i = 0; i < length; i++) {
+        tracker.saw(values[i], counter.increment(values[i]));
+    }
+
+    if (tracker.tied) {
+        printf("TOO MANY MODES\n");
+        return 0;
+    }
+    return tracker.best_value;
+}
+
+// The original std::map-based mode, kept as the baseline for benchmark_mode
+template<Integer T>
+T mode_map(const T* values, size_t length) {
+    if (length <= 0) {
+        printf("NO VALUES GIVEN\n");
+        return 0;
+    }
+
     std::map<T, int> val_occurance_counts;
 
     for(size_t i = 0; i < length; i++) {
@@ -72,25 +262,62 @@ T mode(const T* values, size_t length) {
     }
 }
 
+// The default deleter. It has no members, so stored through EBO (below) it takes up no space at all.
+template <typename T>
+struct DefaultDelete {
+    void operator()(T* pointer) const {
+        delete pointer;
+    }
+};
+
+/*
+ * Empty Base Optimization (EBO): a member always takes at least one byte (plus padding up to the pointer's alignment),
+ * but an empty base class can take none. Deleters that can be base classes (DefaultDelete, lambdas, function objects)
+ * are inherited from; the rest (function pointers, final classes) are stored as an ordinary member.
+ */
+template <typename Deleter, bool = std::is_class_v<Deleter> && !std::is_final_v<Deleter>>
+struct DeleterStorage : private Deleter {
+    DeleterStorage() = default;
+    DeleterStorage(Deleter deleter) : Deleter{ std::move(deleter) } {}
+    Deleter& deleter() { return *this; }
+};
+
+template <typename Deleter>
+struct DeleterStorage<Deleter, false> {
+    DeleterStorage() = default;
+    DeleterStorage(Deleter deleter) : stored { deleter } {}
+    Deleter& deleter() { return stored; }
+    private:
+        Deleter stored{};
+};
+
 /* 
  * RAII wrapper around pointer objects so that, 
  * when the wrapper is deleted, the underlying object is also deleted.
  * This a pedagogical implementation of std::unique_ptr, part of the RAII template group in std called smart pointers
+ * Like std::unique_ptr it takes an optional Deleter, e.g. to fclose a FILE*; thanks to EBO an empty one is free.
  */
-template <typename T>
-struct SimpleUniquePointer {
+template <typename T, typename Deleter = DefaultDelete<T>>
+struct SimpleUniquePointer : private DeleterStorage<Deleter> {
     // default used when you need both a default and non-default constructor
-    // default constructor will set pointer to nullptr due to default initialization rules
-    SimpleUniquePointer() = default; 
+    // the default member initializer below sets pointer to nullptr
+    // Like std::unique_ptr, these two need a deleter that is usable when value-initialized: a function-pointer
+    // deleter would start out as nullptr and the destructor would call it, so it has to be passed explicitly.
+    SimpleUniquePointer() requires (!std::is_pointer_v<Deleter>) = default; 
     
-    SimpleUniquePointer(T* pointer) 
+    SimpleUniquePointer(T* pointer) requires (!std::is_pointer_v<Deleter>)
         : pointer { pointer } {
 
     }
 
+    SimpleUniquePointer(T* pointer, Deleter deleter)
+        : DeleterStorage<Deleter> { std::move(deleter) }, pointer { pointer } {
+
+    }
+
     ~SimpleUniquePointer() {
         // Make sure pointer is not nullptr before deleting
-        if (pointer) delete pointer;
+        if (pointer) this->deleter()(pointer);
     }
 
     // =delete: prevents compiler from automatically generating functions and operators
@@ -98,24 +325,35 @@ struct SimpleUniquePointer {
     SimpleUniquePointer(const SimpleUniquePointer&) = delete;
     SimpleUniquePointer& operator=(const SimpleUniquePointer&) = delete;
     SimpleUniquePointer(SimpleUniquePointer&& other) noexcept
-        : pointer { other.pointer } {
+        : DeleterStorage<Deleter> { std::move(other.deleter()) }, pointer { other.pointer } {
         other.pointer = nullptr;        
     }
-    SimpleUniquePointer& operator=(const SimpleUniquePointer&& other) noexcept {
-        if (pointer) delete pointer; // make sure to delete whatever is being held before reassigning
+    SimpleUniquePointer& operator=(SimpleUniquePointer&& other) noexcept {
+        if (this == &other) return *this;
+        if (pointer) this->deleter()(pointer); // make sure to delete whatever is being held before reassigning
+        this->deleter() = std::move(other.deleter());
         pointer = other.pointer;
         other.pointer = nullptr;
         return *this;
     }
 
-    T* get() {
+    T* get() const {
         return pointer;
     }
 
+    Deleter& get_deleter() {
+        return this->deleter();
+    }
+
     private:
-        T* pointer;
+        T* pointer{};
 };
 
+static_assert(sizeof(SimpleUniquePointer<int>) == sizeof(int*), "DefaultDelete must cost nothing");
+static_assert(!std::is_default_constructible_v<SimpleUniquePointer<FILE, int (*)(FILE*)>> &&
+              !std::is_constructible_v<SimpleUniquePointer<FILE, int (*)(FILE*)>, FILE*>,
+              "a function-pointer deleter must be passed in, never value-initialized to nullptr");
+
 struct Tracer {
     Tracer(const char* name)
         : name { name } {
@@ -134,6 +372,43 @@ void consumer(SimpleUniquePointer<Tracer> consumer_ptr) {
     printf("(cons) consumer_ptr: 0x%p\n", consumer_ptr.get());
 }
 
+/*
+    Benchmarks mean and mode on telemetry-like int arrays: a narrow value range (counting array path) and a
+    wide one (hash map path). The std::map baseline is skipped at the largest size, where it takes far too long.
+*/
+void benchmark_mode(size_t length) {
+    const auto narrow = new int[length];
+    const auto wide = new int[length];
+    uint32_t state { 0x4c4347 };
+    for (size_t i{}; i < length; i++) {
+        state = state * 1664525 + 1013904223;
+        narrow[i] = (state >> 8) % 1000;
+        wide[i] = static_cast<int>(state ^ (state >> 13)) % 10'000'000;
+    }
+
+    using millis = std::chrono::duration<double, std::milli>;
+    auto time = [](auto&& fn) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = fn();
+        return std::pair { result, millis(std::chrono::steady_clock::now() - start).count() };
+    };
+
+    const auto [m, mean_ms] = time([&] { return mean(wide, length); });
+    const auto [n, narrow_ms] = time([&] { return mode(narrow, length); });
+    const auto [w, wide_ms] = time([&] { return mode(wide, length); });
+    printf("n=%zu: mean %d in %.2f ms, narrow mode %d in %.2f ms, wide mode %d in %.2f ms\n",
+        length, m, mean_ms, n, narrow_ms, w, wide_ms);
+    if (length <= 1'000'000) {
+        const auto [nm, narrow_map_ms] = time([&] { return mode_map(narrow, length); });
+        const auto [wm, wide_map_ms] = time([&] { return mode_map(wide, length); });
+        printf("    std::map baseline: narrow mode %d in %.2f ms, wide mode %d in %.2f ms\n",
+            nm, narrow_map_ms, wm, wide_map_ms);
+    }
+
+    delete[] narrow;
+    delete[] wide;
+}
+
 int main() {
     long longs[] {1, 2, 3};
     int ints[] { 4, 5, 6};
@@ -152,6 +427,25 @@ int main() {
     consumer(std::move(ptr_a));
     printf("(main) ptr_a: 0x%p\n", ptr_a.get()); // ptr_a now in a moved-from state, inner Tracer moved from ptr_a to consumer
 
+    // Custom deleters: an empty function object or lambda is free, a function pointer costs a pointer
+    auto announce = [](Tracer* tracer) {
+        printf("(lambda deleter) ");
+        delete tracer;
+    };
+    struct FileCloser {
+        void operator()(FILE* file) const { fclose(file); }
+    };
+    using LambdaDeleted = SimpleUniquePointer<Tracer, decltype(announce)>;
+    using FunctionPointerDeleted = SimpleUniquePointer<FILE, int (*)(FILE*)>;
+    printf("sizeof: Tracer* %zu, SimpleUniquePointer %zu, with lambda deleter %zu, with FileCloser %zu, with fclose pointer %zu\n",
+        sizeof(Tracer*), sizeof(SimpleUniquePointer<Tracer>), sizeof(LambdaDeleted),
+        sizeof(SimpleUniquePointer<FILE, FileCloser>), sizeof(FunctionPointerDeleted));
+    {
+        LambdaDeleted ptr_b { new Tracer("ptr_b"), announce };
+        SimpleUniquePointer<FILE, FileCloser> file { tmpfile() };
+        printf("tmpfile open: %s\n", file.get() ? "yes" : "no");
+    }
+
     long counts_too_many[] = {12, 24, 24, 54, 1, 3, 7, 7, 9, 9};
     mode(counts_too_many, 8);
     int counts_none[] = {};
@@ -159,5 +453,9 @@ int main() {
     int counts_good[] = {1, 1, 1, 2, 2, 3, 4, 5, 6, 6, 6, 6};
     auto m_mode = mode(counts_good, 12);
     printf("MODE! %d\n", m_mode);
+
+    benchmark_mode(1'000);
+    benchmark_mode(1'000'000);
+    benchmark_mode(100'000'000);
     return 0;
 }
\ No newline at end of file
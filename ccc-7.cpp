@@ -3,6 +3,15 @@
 #include <cstdio>
 #include <new>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <bit>
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 /*
     Operator Overloading: process of defining custom behavior for operators.
@@ -41,50 +50,381 @@ struct Bucket {
 };
 
 /*
-    Implements a heap by using a set series of Buckets instead of free memory.
+    Implements a heap as a slab allocator carved out of a single arena instead of free memory.
+        - The arena is split into Bucket-sized slabs, and each slab is dedicated to one size class
+          (16, 32, 64, ..., 4096 bytes). A 4-byte unsigned int now costs 16 bytes instead of a whole Bucket.
+        - Freed blocks go on an intrusive free list per size class: the first bytes of the freed block itself
+          hold the pointer to the next free block, so the list costs no extra memory.
+        - Finding which slab (and therefore which size class) a pointer belongs to is address arithmetic:
+          (p - arena) / Bucket::data_size. No searching.
+        - allocate and free are both O(1): pop/push the free list, or bump-carve the slab currently being filled.
+
+    The heap itself has no synchronization. To run it under several threads pick a HeapMode:
+        - SingleThreaded: no locking at all (the default)
+        - Locked: one big mutex around every allocate/free
+        - ThreadCached: each thread allocates from its own ThreadCache (see below) and only locks the heap
+          to move whole batches of blocks in or out
 */
+enum class HeapMode { SingleThreaded, Locked, ThreadCached };
+
 struct Heap {
-    // Attempts to allocate a new bucket of memory
+    static const size_t min_block_size { 16 };
+    static const size_t n_size_classes { 9 }; // 16, 32, 64, 128, 256, 512, 1024, 2048, 4096
+    static const size_t default_arena_size { 64 * Bucket::data_size };
+
+    struct ClassStats {
+        size_t block_size;
+        size_t in_use;     // blocks currently handed out
+        size_t high_water; // most blocks ever handed out at once
+        size_t slabs;      // slabs dedicated to this class
+    };
+
+    // constexpr so the global heap is constant-initialized: operator new may be called before main() runs
+    constexpr Heap(size_t arena_size = default_arena_size)
+        : arena_size { arena_size } {}
+
+    // The arena can only be resized before the first allocation has carved it up.
+    bool configure(size_t new_arena_size) {
+        if (arena) return false;
+        arena_size = new_arena_size;
+        return true;
+    }
+
+    // Only switch modes while a single thread is running. Threaded modes map the arena up front so that
+    // free() never races with the lazy mapping.
+    bool set_mode(HeapMode new_mode) {
+        if (new_mode != HeapMode::SingleThreaded && !arena && !map_arena()) return false;
+        mode = new_mode;
+        return true;
+    }
+
+    HeapMode get_mode() const {
+        return mode;
+    }
+
     void* allocate(size_t bytes) {
         // Enforce that number of bytes requested must be less than a single bucket
         if (bytes > Bucket::data_size) throw std::bad_alloc{};
+        if (!arena && !map_arena()) throw std::bad_alloc{};
 
-        // Find the next available bucket and return its contents, i.e. a byte array used for holding data
-        for(size_t i{}; i < n_heap_buckets; i++) {
-            if (!bucket_used[i]) {
-                bucket_used[i] = true;
-                return buckets[i].data;
-            }
-        }
-
-        throw std::bad_alloc{};
+        const auto block = allocate_block(size_class(bytes));
+        if (!block) throw std::bad_alloc{};
+        return block;
     }
 
-    // "Frees" memory by resetting flag for corresponding bucket to say it is usable again.
+    // Pushes the block back onto its size class' free list.
     // Note: void pointers have no associated type: they deal in raw memory.
     void free(void* p) {
-        for (size_t i{}; i < n_heap_buckets; i++) {
-            if (buckets[i].data == p) {
-                bucket_used[i] = false;
-                return;
+        const auto index = class_of(p);
+        if (index != n_size_classes) free_block(p, index);
+    }
+
+    void* allocate_locked(size_t bytes) {
+        std::lock_guard<std::mutex> guard { lock };
+        return allocate(bytes);
+    }
+
+    void free_locked(void* p) {
+        std::lock_guard<std::mutex> guard { lock };
+        free(p);
+    }
+
+    // Batch operations for the thread caches: one lock round-trip per batch instead of one per block.
+    // Returns how many blocks were handed out, which is less than n once the arena runs out.
+    size_t allocate_batch(size_t index, void** out, size_t n) {
+        std::lock_guard<std::mutex> guard { lock };
+        size_t count{};
+        while (count < n && (out[count] = allocate_block(index))) {
+            count++;
+        }
+        return count;
+    }
+
+    void free_batch(void* const* blocks, size_t index, size_t n) {
+        std::lock_guard<std::mutex> guard { lock };
+        for (size_t i{}; i < n; i++) {
+            free_block(blocks[i], index);
+        }
+    }
+
+    static constexpr size_t size_class(size_t bytes) {
+        return bytes <= min_block_size ? 0 : std::bit_width(bytes - 1) - std::bit_width(min_block_size - 1);
+    }
+
+    // Size class of the slab p lives in, or n_size_classes if p is not from the arena.
+    // Needs no lock: a slab's class is written before any of its blocks are handed out.
+    size_t class_of(const void* p) const {
+        const auto address = reinterpret_cast<uintptr_t>(p);
+        const auto base = reinterpret_cast<uintptr_t>(arena);
+        if (!arena || address < base || address >= base + n_slabs * Bucket::data_size) return n_size_classes;
+        return slab_class[(address - base) / Bucket::data_size];
+    }
+
+    const std::byte* arena_start() const {
+        return arena;
+    }
+
+    ClassStats class_stats(size_t index) const {
+        const auto& sc = classes[index];
+        return ClassStats { block_size(index), sc.in_use, sc.high_water, sc.slabs };
+    }
+
+    // Blocks parked in a thread's magazine count as in use: the heap handed them out
+    size_t bytes_in_use() const {
+        size_t result{};
+        for (size_t i{}; i < n_size_classes; i++) {
+            result += classes[i].in_use * block_size(i);
+        }
+        return result;
+    }
+
+    // Bytes of slabs that have been dedicated to some size class
+    size_t bytes_reserved() const {
+        return next_slab * Bucket::data_size;
+    }
+
+    // Share of reserved memory not backing a live block: free-listed blocks plus uncarved slab tails
+    double fragmentation() const {
+        const auto reserved = bytes_reserved();
+        return reserved ? 1.0 - static_cast<double>(bytes_in_use()) / reserved : 0.0;
+    }
+
+    void print_stats() const {
+        printf("Heap: %zu/%zu bytes in use, %zu/%zu slabs, fragmentation %.2f\n",
+            bytes_in_use(), bytes_reserved(), next_slab, n_slabs, fragmentation());
+        for (size_t i{}; i < n_size_classes; i++) {
+            const auto stats = class_stats(i);
+            if (!stats.slabs) continue;
+            printf("  %4zu-byte class: %zu in use, high-water %zu, %zu slab(s)\n",
+                stats.block_size, stats.in_use, stats.high_water, stats.slabs);
+        }
+    }
+
+    private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        FreeBlock* free_list {};
+        std::byte* bump {};
+        std::byte* bump_end {};
+        size_t in_use {};
+        size_t high_water {};
+        size_t slabs {};
+    };
+
+    // Returns nullptr when the arena has no slab left for this class
+    void* allocate_block(size_t index) {
+        auto& sc = classes[index];
+        void* block;
+
+        if (sc.free_list) {
+            block = sc.free_list;
+            sc.free_list = sc.free_list->next;
+        } else {
+            // Current slab is used up, so dedicate the next untouched slab in the arena to this class
+            if (sc.bump == sc.bump_end) {
+                if (next_slab == n_slabs) return nullptr;
+                slab_class[next_slab] = static_cast<uint8_t>(index);
+                sc.bump = arena + next_slab * Bucket::data_size;
+                sc.bump_end = sc.bump + Bucket::data_size;
+                next_slab++;
+                sc.slabs++;
             }
+            block = sc.bump;
+            sc.bump += block_size(index);
         }
+
+        sc.in_use++;
+        if (sc.in_use > sc.high_water) sc.high_water = sc.in_use;
+        return block;
+    }
+
+    void free_block(void* p, size_t index) {
+        auto& sc = classes[index];
+        auto block = static_cast<FreeBlock*>(p);
+        block->next = sc.free_list;
+        sc.free_list = block;
+        sc.in_use--;
+    }
+
+    static constexpr size_t block_size(size_t index) {
+        return min_block_size << index;
     }
 
-    static const size_t n_heap_buckets { 10 };
-    Bucket buckets[n_heap_buckets];
-    bool bucket_used[n_heap_buckets];
+    // The arena comes from malloc rather than new, otherwise our own operator new would recurse into itself.
+    // It is never released: objects with static storage can still be deleted after the heap would be destroyed.
+    bool map_arena() {
+        n_slabs = arena_size / Bucket::data_size;
+        if (n_slabs == 0) return false;
+        slab_class = static_cast<uint8_t*>(std::malloc(n_slabs));
+        arena = static_cast<std::byte*>(std::aligned_alloc(Bucket::data_size, n_slabs * Bucket::data_size));
+        return arena && slab_class;
+    }
+
+    size_t arena_size;
+    size_t n_slabs {};
+    size_t next_slab {};
+    std::byte* arena {};
+    uint8_t* slab_class {}; // size class of each slab, indexed by slab number
+    SizeClass classes[n_size_classes] {};
+    HeapMode mode { HeapMode::SingleThreaded };
+    std::mutex lock;
 };
 
 // Declare heap and operator overloads in namespace scope so that way
 // compiler picks them up and uses them program-wide.
 // NOTE! THIS IS TERRIBLE TO DO IN REAL LIFE AS STL LIBRARIES WILL BE AFFECTED BY THIS.
 Heap heap;
+
+/*
+    Thread Cache: a thread_local set of magazines, i.e. small stacks of free blocks, one per size class.
+        - allocate pops from the magazine; only an empty magazine goes to the heap, refilling half a magazine at once
+        - free pushes onto the magazine; only a full magazine goes to the heap, draining half a magazine at once
+        - so the common path touches nothing but this thread's memory and takes no lock
+    Cross-thread frees: a block freed on a thread other than the one that allocated it simply joins the freeing
+    thread's magazine. Blocks belong to the heap, not to a thread, so a producer/consumer pair keeps circulating
+    blocks: the consumer's magazine overflows back into the heap and the producer refills from there.
+*/
+struct ThreadCache {
+    static constexpr size_t magazine_size { 64 };
+    static constexpr size_t magazine_bytes { 4 * Bucket::data_size }; // keeps big classes from hoarding whole slabs
+
+    // Hand everything back when the thread exits so its blocks are not stranded
+    ~ThreadCache() {
+        for (size_t i{}; i < Heap::n_size_classes; i++) {
+            heap.free_batch(magazines[i].blocks, i, magazines[i].count);
+            magazines[i].count = 0;
+        }
+        alive = false;
+    }
+
+    void* allocate(size_t bytes) {
+        if (bytes > Bucket::data_size) throw std::bad_alloc{};
+
+        const auto index = Heap::size_class(bytes);
+        auto& mag = magazines[index];
+        if (mag.count == 0) {
+            mag.count = heap.allocate_batch(index, mag.blocks, capacity(index) / 2);
+            if (mag.count == 0) throw std::bad_alloc{};
+        }
+        return mag.blocks[--mag.count];
+    }
+
+    void free(void* p) {
+        const auto index = heap.class_of(p);
+        if (index == Heap::n_size_classes) return;
+
+        // Other thread_local destructors can still delete things after this cache has been torn down
+        if (!alive) {
+            heap.free_batch(&p, index, 1);
+            return;
+        }
+
+        auto& mag = magazines[index];
+        const auto cap = capacity(index);
+        if (mag.count == cap) {
+            // Drain the oldest half and keep the recently freed (cache-hot) blocks on top
+            const auto batch = cap / 2;
+            heap.free_batch(mag.blocks, index, batch);
+            std::copy(mag.blocks + batch, mag.blocks + cap, mag.blocks);
+            mag.count -= batch;
+        }
+        mag.blocks[mag.count++] = p;
+    }
+
+    private:
+    static constexpr size_t capacity(size_t index) {
+        return std::clamp<size_t>(magazine_bytes / (Heap::min_block_size << index), 2, magazine_size);
+    }
+
+    struct Magazine {
+        void* blocks[magazine_size];
+        size_t count {};
+    };
+
+    Magazine magazines[Heap::n_size_classes] {};
+    bool alive { true };
+};
+thread_local ThreadCache thread_cache;
+
 void* operator new(size_t n_bytes) {
-    return heap.allocate(n_bytes);
+    switch (heap.get_mode()) {
+        case HeapMode::ThreadCached: return thread_cache.allocate(n_bytes);
+        case HeapMode::Locked: return heap.allocate_locked(n_bytes);
+        default: return heap.allocate(n_bytes);
+    }
 }
 void operator delete(void* p) {
-    return heap.free(p);
+    switch (heap.get_mode()) {
+        case HeapMode::ThreadCached: return thread_cache.free(p);
+        case HeapMode::Locked: return heap.free_locked(p);
+        default: return heap.free(p);
+    }
+}
+
+/*
+    Allocation rodeo: goat_rodeo from ccc-19_mutex.cpp, but instead of fighting over tin cans the two threads churn
+    through the heap. Each round allocates a handful of differently sized objects and frees them again.
+    A third run makes one thread allocate and the other free, to exercise the cross-thread free path.
+*/
+double allocation_rodeo(HeapMode mode) {
+    const size_t iterations { 200'000 };
+    const size_t n_objects { 8 };
+    heap.set_mode(mode);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto churn = [&] {
+        std::atomic<Bucket*> sink{}; // publishing the Buckets keeps the optimizer from eliding their new/delete pairs
+        for (size_t i{}; i < iterations; i++) {
+            unsigned int* ints[n_objects];
+            Bucket* buckets[n_objects / 4];
+            for (auto& p : ints) p = new unsigned int { 0xC0FFEE };
+            for (auto& p : buckets) sink.store(p = new Bucket, std::memory_order_relaxed);
+            for (auto p : ints) delete p;
+            for (auto p : buckets) delete p;
+        }
+    };
+    auto deposit_cans = std::async(std::launch::async, churn);
+    auto eat_cans = std::async(std::launch::async, churn);
+    deposit_cans.get();
+    eat_cans.get();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    heap.set_mode(HeapMode::SingleThreaded);
+    const auto n_ops = 2.0 * 2 * iterations * (n_objects + n_objects / 4);
+    return std::chrono::duration<double, std::nano>(elapsed).count() / n_ops;
+}
+
+double cross_thread_rodeo(HeapMode mode) {
+    const size_t iterations { 1'000'000 };
+    const size_t ring_size { 256 };
+    unsigned int* ring[ring_size];
+    std::atomic<size_t> produced{}, consumed{};
+    heap.set_mode(mode);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto deposit_cans = std::async(std::launch::async, [&] {
+        for (size_t i{}; i < iterations; i++) {
+            while (i - consumed.load(std::memory_order_acquire) == ring_size) std::this_thread::yield();
+            ring[i % ring_size] = new unsigned int { 0xDEADBEEF };
+            produced.store(i + 1, std::memory_order_release);
+        }
+    });
+    auto eat_cans = std::async(std::launch::async, [&] {
+        for (size_t i{}; i < iterations; i++) {
+            while (produced.load(std::memory_order_acquire) == i) std::this_thread::yield();
+            delete ring[i % ring_size];
+            consumed.store(i + 1, std::memory_order_release);
+        }
+    });
+    deposit_cans.get();
+    eat_cans.get();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    heap.set_mode(HeapMode::SingleThreaded);
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (2.0 * iterations);
 }
 
 
@@ -117,7 +457,13 @@ struct ReadOnlyInt {
 
 */
 
-int main() {
+int main(int argc, char** argv) {
+    // Arena size can be chosen at startup, e.g. ./ccc-7 1048576
+    if (argc > 1 && !heap.configure(std::strtoull(argv[1], nullptr, 10))) {
+        printf("Heap already in use, keeping default arena size\n");
+    }
+
+
     CheckedInteger a { 100 };
     auto b = a + 200;
     printf("a + 200 = %u\n", b.value);
@@ -127,23 +473,36 @@ int main() {
         printf("(a + max) EXCEPTION: %s\n", e.what());
     }
 
-    printf("Buckets! %p\n", heap.buckets);
     auto breakfast = new unsigned int { 0xC0FFEE };
     auto dinner = new unsigned int { 0xDEADBEEF };
-    printf("Breakfast: %p 0x%x\n", breakfast, *breakfast); // Note how breakfast address is same as buckets. Starts at beginning of heap
-    printf("Dinner: %p 0x%x\n", dinner, *dinner); // Note how address is so 0x1000 bytes (4096) of breakfast, even though the actual data contents is tiny
+    printf("Arena! %p\n", heap.arena_start());
+    printf("Breakfast: %p 0x%x\n", breakfast, *breakfast); // Note how breakfast starts a slab: the overflow_error above already claimed the arena's first slab for its message
+    printf("Dinner: %p 0x%x\n", dinner, *dinner); // Note how address is only 0x10 bytes (16) after breakfast: both live in the 16-byte class
     delete breakfast;
     delete dinner;
 
+    auto recycled = new unsigned int { 0xBADF00D };
+    printf("Recycled: %p 0x%x\n", recycled, *recycled); // Free list is LIFO, so this reuses dinner's block
+    delete recycled;
+
+    printf("Two-thread churn, one big lock:  %.1f ns/op\n", allocation_rodeo(HeapMode::Locked));
+    printf("Two-thread churn, thread caches: %.1f ns/op\n", allocation_rodeo(HeapMode::ThreadCached));
+    printf("Cross-thread free, one big lock:  %.1f ns/op\n", cross_thread_rodeo(HeapMode::Locked));
+    printf("Cross-thread free, thread caches: %.1f ns/op\n", cross_thread_rodeo(HeapMode::ThreadCached));
+    heap.print_stats();
+
+    size_t n_chars{};
+    char* last_char{}; // printed below so the optimizer can't drop the "unused" allocations
     try {
-        // This should get run 10 times, i.e. the number of buckets in the heap
+        // This should get run until every slab in the arena is dedicated to the 16-byte class and used up
         while(true) {
-            auto thing = new char;
-            printf("Allocated a char. %p\n", thing);
+            last_char = new char;
+            n_chars++;
         }
     } catch(const std::bad_alloc&) {
-        printf("std::bad_alloc caught\n");
+        printf("std::bad_alloc caught after %zu chars, last at %p\n", n_chars, last_char);
     }
+    heap.print_stats();
 
     // Using User-defined conversion
     ReadOnlyInt ro_int { 42 };
@@ -2,6 +2,17 @@
 #include <cstdio>
 #include <string>
 #include <cstring>
+#include <charconv>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+// SIMD paths are picked at compile time: build with -mavx2 (or -msse4.1) on x86; AArch64 always has NEON.
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 /*
     Constant Expressions:
@@ -71,17 +82,290 @@ constexpr Color rgb_to_hsv(uint8_t r, uint8_t g, uint8_t b) {
     return c;
 }
 
+/*
+    Branchless version for batch work: every pixel runs the same instructions, the hue sector is picked with
+    selects instead of if/else, and the three divisions by delta become one. Working on 0-255 values directly
+    also saves the /255.0f on every channel.
+*/
+constexpr Color rgb_to_hsv_branchless(uint8_t r, uint8_t g, uint8_t b) {
+    const float R = r, G = g, B = b;
+    const float c_max = max(r, g, b);
+    const float delta = c_max - min(r, g, b);
+
+    const bool is_r = c_max == R;
+    const bool is_g = !is_r && c_max == G;
+    const float numerator = is_r ? G - B : is_g ? B - R + 2.0f * delta : R - G + 4.0f * delta;
+    const float hue = delta > 0.0f ? 60.0f * numerator / delta : 0.0f;
+
+    Color c{};
+    c.V = c_max / 255.0f;
+    c.S = c_max > 0.0f ? delta / c_max : 0.0f;
+    c.H = hue < 0.0f ? hue + 360.0f : hue;
+    return c;
+}
+
+/*
+    Batch conversion of planar RGB (separate r, g, b byte planes) into planar H, S and V floats.
+    The SIMD kernels are the branchless formula above, 8 (AVX2) or 4 (SSE4.1/NEON) pixels at a time, using
+    compare masks + blends for the hue sector. Leftover pixels go through the scalar version.
+*/
+void rgb_to_hsv_planar(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                       float* h, float* s, float* v, size_t n_pixels) {
+    size_t i{};
+#if defined(__AVX2__)
+    const auto zero = _mm256_setzero_ps();
+    const auto inv_255 = _mm256_set1_ps(1.0f / 255.0f);
+    auto load = [](const uint8_t* p) {
+        return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+    };
+    for (; i + 8 <= n_pixels; i += 8) {
+        const auto R = load(r + i), G = load(g + i), B = load(b + i);
+        const auto c_max = _mm256_max_ps(R, _mm256_max_ps(G, B));
+        const auto delta = _mm256_sub_ps(c_max, _mm256_min_ps(R, _mm256_min_ps(G, B)));
+
+        const auto is_r = _mm256_cmp_ps(c_max, R, _CMP_EQ_OQ);
+        const auto is_g = _mm256_andnot_ps(is_r, _mm256_cmp_ps(c_max, G, _CMP_EQ_OQ));
+        const auto from_r = _mm256_sub_ps(G, B);
+        const auto from_g = _mm256_add_ps(_mm256_sub_ps(B, R), _mm256_add_ps(delta, delta));
+        const auto from_b = _mm256_add_ps(_mm256_sub_ps(R, G), _mm256_mul_ps(delta, _mm256_set1_ps(4.0f)));
+        const auto numerator = _mm256_blendv_ps(_mm256_blendv_ps(from_b, from_g, is_g), from_r, is_r);
+
+        // 0/0 lanes (grey pixels, black) produce NaN and are masked back to 0
+        auto hue = _mm256_mul_ps(_mm256_set1_ps(60.0f), _mm256_div_ps(numerator, delta));
+        hue = _mm256_and_ps(hue, _mm256_cmp_ps(delta, zero, _CMP_GT_OQ));
+        hue = _mm256_add_ps(hue, _mm256_and_ps(_mm256_cmp_ps(hue, zero, _CMP_LT_OQ), _mm256_set1_ps(360.0f)));
+        const auto sat = _mm256_and_ps(_mm256_div_ps(delta, c_max), _mm256_cmp_ps(c_max, zero, _CMP_GT_OQ));
+
+        _mm256_storeu_ps(h + i, hue);
+        _mm256_storeu_ps(s + i, sat);
+        _mm256_storeu_ps(v + i, _mm256_mul_ps(c_max, inv_255));
+    }
+#elif defined(__SSE4_1__)
+    const auto zero = _mm_setzero_ps();
+    const auto inv_255 = _mm_set1_ps(1.0f / 255.0f);
+    auto load = [](const uint8_t* p) {
+        int32_t bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes)));
+    };
+    for (; i + 4 <= n_pixels; i += 4) {
+        const auto R = load(r + i), G = load(g + i), B = load(b + i);
+        const auto c_max = _mm_max_ps(R, _mm_max_ps(G, B));
+        const auto delta = _mm_sub_ps(c_max, _mm_min_ps(R, _mm_min_ps(G, B)));
+
+        const auto is_r = _mm_cmpeq_ps(c_max, R);
+        const auto is_g = _mm_andnot_ps(is_r, _mm_cmpeq_ps(c_max, G));
+        const auto from_r = _mm_sub_ps(G, B);
+        const auto from_g = _mm_add_ps(_mm_sub_ps(B, R), _mm_add_ps(delta, delta));
+        const auto from_b = _mm_add_ps(_mm_sub_ps(R, G), _mm_mul_ps(delta, _mm_set1_ps(4.0f)));
+        const auto numerator = _mm_blendv_ps(_mm_blendv_ps(from_b, from_g, is_g), from_r, is_r);
+
+        auto hue = _mm_mul_ps(_mm_set1_ps(60.0f), _mm_div_ps(numerator, delta));
+        hue = _mm_and_ps(hue, _mm_cmpgt_ps(delta, zero));
+        hue = _mm_add_ps(hue, _mm_and_ps(_mm_cmplt_ps(hue, zero), _mm_set1_ps(360.0f)));
+        const auto sat = _mm_and_ps(_mm_div_ps(delta, c_max), _mm_cmpgt_ps(c_max, zero));
+
+        _mm_storeu_ps(h + i, hue);
+        _mm_storeu_ps(s + i, sat);
+        _mm_storeu_ps(v + i, _mm_mul_ps(c_max, inv_255));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const auto zero = vdupq_n_f32(0.0f);
+    const auto full_turn = vreinterpretq_u32_f32(vdupq_n_f32(360.0f));
+    auto convert4 = [&](float32x4_t R, float32x4_t G, float32x4_t B, size_t at) {
+        const auto c_max = vmaxq_f32(R, vmaxq_f32(G, B));
+        const auto delta = vsubq_f32(c_max, vminq_f32(R, vminq_f32(G, B)));
+
+        const auto is_r = vceqq_f32(c_max, R);
+        const auto is_g = vandq_u32(vceqq_f32(c_max, G), vmvnq_u32(is_r));
+        const auto from_r = vsubq_f32(G, B);
+        const auto from_g = vmlaq_n_f32(vsubq_f32(B, R), delta, 2.0f);
+        const auto from_b = vmlaq_n_f32(vsubq_f32(R, G), delta, 4.0f);
+        const auto numerator = vbslq_f32(is_r, from_r, vbslq_f32(is_g, from_g, from_b));
+
+        auto hue = vmulq_n_f32(vdivq_f32(numerator, delta), 60.0f);
+        hue = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(hue), vcgtq_f32(delta, zero)));
+        hue = vaddq_f32(hue, vreinterpretq_f32_u32(vandq_u32(vcltq_f32(hue, zero), full_turn)));
+        const auto sat = vreinterpretq_f32_u32(
+            vandq_u32(vreinterpretq_u32_f32(vdivq_f32(delta, c_max)), vcgtq_f32(c_max, zero)));
+
+        vst1q_f32(h + at, hue);
+        vst1q_f32(s + at, sat);
+        vst1q_f32(v + at, vmulq_n_f32(c_max, 1.0f / 255.0f));
+    };
+    auto widen = [](uint8x8_t bytes, bool high) {
+        const auto words = vmovl_u8(bytes);
+        return vcvtq_f32_u32(vmovl_u16(high ? vget_high_u16(words) : vget_low_u16(words)));
+    };
+    for (; i + 8 <= n_pixels; i += 8) {
+        const auto R = vld1_u8(r + i), G = vld1_u8(g + i), B = vld1_u8(b + i);
+        convert4(widen(R, false), widen(G, false), widen(B, false), i);
+        convert4(widen(R, true), widen(G, true), widen(B, true), i + 4);
+    }
+#endif
+    for (; i < n_pixels; i++) {
+        const auto c = rgb_to_hsv_branchless(r[i], g[i], b[i]);
+        h[i] = c.H;
+        s[i] = c.S;
+        v[i] = c.V;
+    }
+}
+
+/*
+    Batch conversion for interleaved RGBRGB... frames: each block of pixels is split into small planes on the
+    stack (they stay in L1), converted with the planar kernel and written back out as Colors.
+*/
+void rgb_to_hsv_batch(const uint8_t* rgb, Color* out, size_t n_pixels) {
+    const size_t block { 256 };
+    uint8_t r[block], g[block], b[block];
+    float h[block], s[block], v[block];
+
+    for (size_t start{}; start < n_pixels; start += block) {
+        const auto n = n_pixels - start < block ? n_pixels - start : block;
+        const auto pixels = rgb + 3 * start;
+        for (size_t i{}; i < n; i++) {
+            r[i] = pixels[3 * i];
+            g[i] = pixels[3 * i + 1];
+            b[i] = pixels[3 * i + 2];
+        }
+        rgb_to_hsv_planar(r, g, b, h, s, v, n);
+        for (size_t i{}; i < n; i++) {
+            out[start + i] = Color { h[i], s[i], v[i] };
+        }
+    }
+}
+
+/*
+    8-bit quantized HSV: H scaled so 256 steps make a full turn, S and V in 0-255.
+    The divisions are replaced by a constexpr-generated table of 16-bit fixed-point reciprocals, 65536 / x,
+    which the compiler builds once at compile time. The whole conversion is integer math plus two lookups.
+*/
+struct Color8 {
+    uint8_t H;
+    uint8_t S;
+    uint8_t V;
+};
+
+constexpr std::array<uint32_t, 256> make_reciprocal_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t x { 1 }; x < 256; x++) {
+        table[x] = (65536 + x / 2) / x;
+    }
+    return table;
+}
+constexpr auto reciprocal_table = make_reciprocal_table();
+
+constexpr Color8 rgb_to_hsv8(uint8_t r, uint8_t g, uint8_t b) {
+    const int32_t c_max = max(r, g, b);
+    const int32_t delta = c_max - min(r, g, b);
+
+    const bool is_r = c_max == r;
+    const bool is_g = !is_r && c_max == g;
+    // position on the colour wheel in units of delta: [-1, 1) for red, [1, 3) for green, [3, 5) for blue
+    const int32_t numerator = is_r ? g - b : is_g ? b - r + 2 * delta : r - g + 4 * delta;
+    // numerator / delta sixths of a turn, scaled to 256 steps per turn: * 256 / 6 == * 128 / 3
+    const int64_t hue = (int64_t { numerator } * reciprocal_table[delta] * 128 / 3) >> 16;
+
+    return Color8 {
+        static_cast<uint8_t>(hue & 0xFF),
+        static_cast<uint8_t>((255 * delta * reciprocal_table[c_max] + 32768) >> 16),
+        static_cast<uint8_t>(c_max)
+    };
+}
+static_assert(rgb_to_hsv8(255, 0, 0).H == 0 && rgb_to_hsv8(255, 0, 0).S == 255);
+static_assert(rgb_to_hsv8(0, 0, 255).H == 170); // 240 degrees
+
+void rgb_to_hsv8_batch(const uint8_t* rgb, Color8* out, size_t n_pixels) {
+    for (size_t i{}; i < n_pixels; i++) {
+        out[i] = rgb_to_hsv8(rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2]);
+    }
+}
+
+// Non-allocating version: formats into the caller's buffer and returns the would-be length, like snprintf.
+// std::to_chars writes the shortest digits that read back as the same float ("<300, 0.5, 1>" rather than
+// "<300.000000, 0.500000, 1.000000>"), ignores the locale and never allocates.
+int color_to_string(const Color color, char* buffer, size_t size) {
+    char text[64];  // 3 floats of at most 15 characters plus separators
+    auto out = text;
+    *out++ = '<';
+    for (const auto& [value, separator] : { std::pair{ color.H, ", " }, { color.S, ", " }, { color.V, ">" } }) {
+        out = std::to_chars(out, text + sizeof(text), value).ptr;
+        for (auto c = separator; *c; c++) *out++ = *c;
+    }
+    const auto length = static_cast<size_t>(out - text);
+    if (size > 0) {
+        const auto copied = length < size ? length : size - 1;
+        std::memcpy(buffer, text, copied);
+        buffer[copied] = '\0';
+    }
+    return static_cast<int>(length);
+}
+
+// Allocates a new char[] on every call: the caller has to delete[] it.
 char* color_to_string(const Color color) {
-    // create std:string to make use of concatenation ease
-    std::string concat_str = "<" + std::to_string(color.H) + ", " + std::to_string(color.S) + ", " + std::to_string(color.V) + ">";
-    // create new char* with size of string plus 1 for null terminator
-    char* result = new char[concat_str.size()+1];
-    // copy c_str into array. Note! simply using = won't work because arrays
-    std::strcpy(result, concat_str.c_str());
-    // return result
+    // one exact-size allocation instead of the temporaries of "<" + std::to_string(...) + ...
+    char text[64];
+    const auto length = color_to_string(color, text, sizeof(text));
+    // new char* with size of string plus 1 for null terminator
+    char* result = new char[length + 1];
+    // copy into array. Note! simply using = won't work because arrays
+    std::memcpy(result, text, static_cast<size_t>(length) + 1);
     return result;
     }
 
+// Converts a random 1080p frame (about 2 megapixels) with every path and reports megapixels per second
+void benchmark_frame() {
+    const size_t width { 1920 }, height { 1080 }, n_pixels { width * height };
+    const auto rgb = new uint8_t[3 * n_pixels];
+    uint32_t state { 0xC0FFEE };
+    for (size_t i{}; i < 3 * n_pixels; i++) {
+        state = state * 1664525 + 1013904223;
+        rgb[i] = static_cast<uint8_t>(state >> 24);
+    }
+    const auto reference = new Color[n_pixels];
+    const auto batch = new Color[n_pixels];
+    const auto quantized = new Color8[n_pixels];
+
+    auto time = [&](const char* name, auto&& run) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-28s %8.1f MP/s\n", name, n_pixels / elapsed.count() / 1e6);
+    };
+    time("rgb_to_hsv per pixel", [&] {
+        for (size_t i{}; i < n_pixels; i++) {
+            reference[i] = rgb_to_hsv(rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2]);
+        }
+    });
+    time("rgb_to_hsv batch", [&] { rgb_to_hsv_batch(rgb, batch, n_pixels); });
+    time("rgb_to_hsv8 lookup table", [&] { rgb_to_hsv8_batch(rgb, quantized, n_pixels); });
+
+    size_t characters{};
+    char text[64];
+    time("color_to_string (to_chars)", [&] {
+        for (size_t i{}; i < n_pixels; i++) characters += static_cast<size_t>(color_to_string(reference[i], text, sizeof(text)));
+    });
+    time("snprintf(\"<%f, %f, %f>\")", [&] {
+        for (size_t i{}; i < n_pixels; i++) {
+            characters += static_cast<size_t>(snprintf(text, sizeof(text), "<%f, %f, %f>", reference[i].H, reference[i].S, reference[i].V));
+        }
+    });
+    printf("(%zu characters formatted)\n", characters);
+
+    float worst{};
+    for (size_t i{}; i < n_pixels; i++) {
+        worst = fmaxf(worst, fabsf(reference[i].H - batch[i].H));
+        worst = fmaxf(worst, 360.0f * fabsf(reference[i].S - batch[i].S));
+        worst = fmaxf(worst, 360.0f * fabsf(reference[i].V - batch[i].V));
+    }
+    printf("Largest batch vs per-pixel difference: %g degrees\n", worst);
+
+    delete[] rgb;
+    delete[] reference;
+    delete[] batch;
+    delete[] quantized;
+}
+
 int main() {
     
     auto black  = rgb_to_hsv(0,   0,     0);
@@ -91,12 +375,21 @@ int main() {
     auto green  = rgb_to_hsv(0,   0,   255);
     auto purple = rgb_to_hsv(255, 0,   255);
 
-    printf("BLACK: %s\n", color_to_string(black));
-    printf("WHITE: %s\n", color_to_string(white));
-    printf("RED: %s\n", color_to_string(red));
-    printf("BLUE: %s\n", color_to_string(blue));
-    printf("GREEN: %s\n", color_to_string(green));
-    printf("PURPLE: %s\n", color_to_string(purple));
+    char buffer[64];
+    color_to_string(black, buffer, sizeof(buffer));
+    printf("BLACK: %s\n", buffer);
+    color_to_string(white, buffer, sizeof(buffer));
+    printf("WHITE: %s\n", buffer);
+    color_to_string(red, buffer, sizeof(buffer));
+    printf("RED: %s\n", buffer);
+    color_to_string(blue, buffer, sizeof(buffer));
+    printf("BLUE: %s\n", buffer);
+    color_to_string(green, buffer, sizeof(buffer));
+    printf("GREEN: %s\n", buffer);
+    color_to_string(purple, buffer, sizeof(buffer));
+    printf("PURPLE: %s\n", buffer);
+
+    benchmark_frame();
 
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,27 @@
 #include <cstdio>
 #include <cstdint>
 #include <stdexcept>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+#include <limits>
+#include <span>
+#include <vector>
+#include <chrono>
+// cast_n packs with SIMD when built with -mavx2; otherwise it uses plain loops the compiler may vectorize itself
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // function definition: signature of the function
 // Allows usage of function before declaration (i.e. implementation)
@@ -18,18 +39,119 @@ namespace AVeryUniqueNamespace {
     }
 }
 
-// type aliases (explained below) can also be used with templates to perform partial application (fixing the number
-// of paramters in a template in order to produce a template with fewer arguments)
+/*
+    When every From value fits in To (e.g. short -> int), always_fits is true and cast compiles down to a plain
+    static_cast with no check. Integers are range-checked with std::in_range, which also catches sign changes a
+    round trip misses (-1 -> unsigned -> -1 round-trips fine but isn't the same value); other types still round-trip.
+
+    cast_n narrows a whole buffer without throwing. It returns the index of the first element that doesn't fit, or
+    in.size() if they all do. It works in blocks: the block's min and max are checked first (one vectorizable pass
+    without branches), then the block is narrowed (AVX2 packs for int -> short / unsigned short). When a block fails,
+    everything before the bad element has still been written to out.
+*/
 template<typename To, typename From>
 struct NarrowCaster {
-    To cast(From value) {
-        const auto converted = static_cast<To>(value);
-        const auto backward = static_cast<From>(converted);
-        if (value != backward) throw std::runtime_error{"Narrowed!"};
-        return converted;
+    static constexpr bool always_fits = [] {
+        if constexpr (std::is_integral_v<From> && std::is_integral_v<To>) {
+            return std::in_range<To>(std::numeric_limits<From>::min()) && std::in_range<To>(std::numeric_limits<From>::max());
+        } else {
+            return std::is_floating_point_v<From> && std::is_floating_point_v<To> && sizeof(To) >= sizeof(From);
+        }
+    }();
+
+    static constexpr bool fits(From value) {
+        if constexpr (always_fits) return true;
+        else if constexpr (std::is_integral_v<From> && std::is_integral_v<To>) return std::in_range<To>(value);
+        else return static_cast<From>(static_cast<To>(value)) == value;
+    }
+
+    constexpr To cast(From value) const {
+        if (!fits(value)) throw std::runtime_error{"Narrowed!"};
+        return static_cast<To>(value);
+    }
+
+    size_t cast_n(std::span<const From> in, std::span<To> out) const {
+        const auto n = in.size() < out.size() ? in.size() : out.size();
+        if constexpr (always_fits) {
+            for (size_t i {}; i < n; i++) out[i] = static_cast<To>(in[i]);
+            return n;
+        } else if constexpr (std::is_integral_v<From> && std::is_integral_v<To>) {
+            const size_t block { 4096 };  // small enough that the narrowing pass reads it back from L1
+            for (size_t base {}; base < n; base += block) {
+                const auto count = n - base < block ? n - base : block;
+                const auto [low, high] = min_max(in.data() + base, count);
+                if (!std::in_range<To>(low) || !std::in_range<To>(high)) {
+                    auto bad = base;
+                    while (fits(in[bad])) {
+                        out[bad] = static_cast<To>(in[bad]);
+                        bad++;
+                    }
+                    return bad;
+                }
+                narrow(in.data() + base, out.data() + base, count);
+            }
+            return n;
+        } else {
+            for (size_t i {}; i < n; i++) {
+                if (!fits(in[i])) return i;
+                out[i] = static_cast<To>(in[i]);
+            }
+            return n;
+        }
+    }
+
+private:
+    static std::pair<From, From> min_max(const From* in, size_t count) {
+        size_t i {};
+        auto low = in[0], high = in[0];
+#if defined(__AVX2__)
+        if constexpr (std::is_same_v<From, int32_t>) {
+            auto low8 = _mm256_set1_epi32(low), high8 = low8;
+            for (; i + 8 <= count; i += 8) {
+                const auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                low8 = _mm256_min_epi32(low8, values);
+                high8 = _mm256_max_epi32(high8, values);
+            }
+            alignas(32) int32_t lows[8], highs[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lows), low8);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(highs), high8);
+            for (int lane {}; lane < 8; lane++) {
+                low = lows[lane] < low ? lows[lane] : low;
+                high = highs[lane] > high ? highs[lane] : high;
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            low = in[i] < low ? in[i] : low;
+            high = in[i] > high ? in[i] : high;
+        }
+        return { low, high };
+    }
+
+    // only called once the block is known to fit, so the saturating packs never actually saturate
+    static void narrow(const From* in, To* out, size_t count) {
+        size_t i {};
+#if defined(__AVX2__)
+        if constexpr (std::is_same_v<From, int32_t> && (std::is_same_v<To, int16_t> || std::is_same_v<To, uint16_t>)) {
+            for (; i + 16 <= count; i += 16) {
+                const auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                const auto second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 8));
+                const auto packed = std::is_same_v<To, int16_t> ? _mm256_packs_epi32(first, second)
+                                                                : _mm256_packus_epi32(first, second);
+                // the packs work within each 128-bit half, so put the four 64-bit quarters back in order
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(packed, 0b11011000));
+            }
+        }
+#endif
+        for (; i < count; i++) out[i] = static_cast<To>(in[i]);
     }
 };
 
+static_assert(NarrowCaster<int, short>::always_fits && !NarrowCaster<short, int>::always_fits);
+static_assert(!NarrowCaster<unsigned, int>::fits(-1) && NarrowCaster<short, int>{}.cast(-32768) == -32768);
+
+// type aliases (explained below) can also be used with templates to perform partial application (fixing the number
+// of paramters in a template in order to produce a template with fewer arguments)
 template<typename From>
 using short_caster = NarrowCaster<short, From>;
 
@@ -39,19 +161,202 @@ using short_caster = NarrowCaster<short, From>;
     Unpacking occurs in top-down order. For example, useful for returning a success flag as well as data instead of
     throwing an error.
 */
-struct TextFile {
-    bool success;
-    const char* data;
-    size_t n_bytes;
+/*
+    TextFile is backed by real I/O: regular files are memory-mapped read-only, so opening a multi-GB file costs the
+    same as opening a tiny one and nothing is copied into the heap - pages are read in by the kernel on first touch.
+    Pipes, terminals and files that report no size (e.g. /proc) can't be mapped; they are streamed into a growing heap
+    buffer instead. Either way the TextFile owns the bytes and releases them (munmap / UnmapViewOfFile / free) when it
+    goes out of scope, so it is move-only.
+    NOTE: data is NOT null-terminated - always use n_bytes.
+
+    Structured bindings only work on all-public structs, and the ownership has to stay private, so TextFile opts in
+    through the tuple protocol instead: std::tuple_size / std::tuple_element plus a get<I>() member (see below the class).
+*/
+enum class AccessHint {
+    Normal,
+    Sequential, // we'll read it front to back: read further ahead and drop pages behind us (MADV_SEQUENTIAL)
+    WillNeed    // start reading the whole file in now (MADV_WILLNEED / PrefetchVirtualMemory)
 };
 
-TextFile read_text_file(const char* path) {
-    const static char contents[] = {"Hey look a fake file how cool."};
-    return TextFile {
-        true, 
-        contents, 
-        sizeof(contents)
+class TextFile {
+public:
+    bool success{};
+    const char* data{};
+    size_t n_bytes{};
+
+    TextFile() = default;
+    ~TextFile() { release(); }
+
+    TextFile(TextFile&& other) noexcept
+        : success{ other.success }, data{ other.data }, n_bytes{ other.n_bytes }, storage{ other.storage } {
+        other.forget();
+    }
+    TextFile& operator=(TextFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            success = other.success;
+            data = other.data;
+            n_bytes = other.n_bytes;
+            storage = other.storage;
+            other.forget();
+        }
+        return *this;
+    }
+    TextFile(const TextFile&) = delete;
+    TextFile& operator=(const TextFile&) = delete;
+
+    bool is_mapped() const { return storage == Storage::Mapped; }
+
+    template <size_t I>
+    auto get() const {
+        static_assert(I < 3, "TextFile unpacks into [success, data, n_bytes]");
+        if constexpr (I == 0) return success;
+        else if constexpr (I == 1) return data;
+        else return n_bytes;
+    }
+
+private:
+    enum class Storage { None, Mapped, Heap };
+
+    friend TextFile read_text_file(const char* path, AccessHint hint);
+
+    void forget() {
+        success = false;
+        data = nullptr;
+        n_bytes = 0;
+        storage = Storage::None;
+    }
+
+    void release() {
+        if (storage == Storage::Mapped) {
+#if defined(_WIN32)
+            UnmapViewOfFile(data);
+#else
+            munmap(const_cast<char*>(data), n_bytes);
+#endif
+        } else if (storage == Storage::Heap) {
+            std::free(const_cast<char*>(data));
+        }
+        forget();
+    }
+
+    Storage storage{ Storage::None };
+};
+
+template <>
+struct std::tuple_size<TextFile> : std::integral_constant<size_t, 3> { };
+template <size_t I>
+struct std::tuple_element<I, TextFile> {
+    using type = decltype(std::declval<const TextFile&>().get<I>());
+};
+
+TextFile read_text_file(const char* path, AccessHint hint = AccessHint::Normal) {
+    TextFile file;
+    char* buffer{};
+    size_t length{}, capacity{};
+    // Streaming fallback: grow the buffer geometrically until the source reports end of file
+    auto stream = [&](auto&& read_some) {
+        for (;;) {
+            if (length == capacity) {
+                capacity = capacity ? capacity * 2 : 64 * 1024;
+                const auto bigger = static_cast<char*>(std::realloc(buffer, capacity));
+                if (!bigger) {
+                    return false;
+                }
+                buffer = bigger;
+            }
+            const auto got = read_some(buffer + length, capacity - length);
+            if (got < 0) {
+                return false;
+            }
+            if (got == 0) {
+                return true;
+            }
+            length += static_cast<size_t>(got);
+        }
     };
+
+#if defined(_WIN32)
+    const auto handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    hint == AccessHint::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL,
+                                    nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return file;
+    }
+    LARGE_INTEGER size{};
+    if (GetFileType(handle) == FILE_TYPE_DISK && GetFileSizeEx(handle, &size) && size.QuadPart > 0) {
+        // the view keeps the mapping alive, so both handles can be closed right away
+        const auto mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const auto view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(handle);
+        if (!view) {
+            return file;
+        }
+        if (hint == AccessHint::WillNeed) {
+            WIN32_MEMORY_RANGE_ENTRY range{ view, static_cast<SIZE_T>(size.QuadPart) };
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+        file.data = static_cast<const char*>(view);
+        file.n_bytes = static_cast<size_t>(size.QuadPart);
+        file.storage = TextFile::Storage::Mapped;
+        file.success = true;
+        return file;
+    }
+    const auto ok = stream([&](char* into, size_t room) -> long long {
+        DWORD got{};
+        const auto chunk = static_cast<DWORD>(room < 0x40000000 ? room : 0x40000000);
+        if (!ReadFile(handle, into, chunk, &got, nullptr)) {
+            return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -1;  // writer closed the pipe: that's end of file
+        }
+        return got;
+    });
+    CloseHandle(handle);
+#else
+    const auto fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return file;
+    }
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        const auto size = static_cast<size_t>(info.st_size);
+        const auto view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);  // the mapping holds its own reference to the file
+        if (view == MAP_FAILED) {
+            return file;
+        }
+        if (hint == AccessHint::Sequential) {
+            madvise(view, size, MADV_SEQUENTIAL);
+        } else if (hint == AccessHint::WillNeed) {
+            madvise(view, size, MADV_WILLNEED);
+        }
+        file.data = static_cast<const char*>(view);
+        file.n_bytes = size;
+        file.storage = TextFile::Storage::Mapped;
+        file.success = true;
+        return file;
+    }
+    const auto ok = stream([&](char* into, size_t room) -> long long {
+        for (;;) {
+            const auto got = read(fd, into, room);
+            if (got >= 0 || errno != EINTR) {
+                return got;
+            }
+        }
+    });
+    close(fd);
+#endif
+    if (!ok) {
+        std::free(buffer);
+        return file;
+    }
+    file.data = buffer;
+    file.n_bytes = length;
+    file.storage = buffer ? TextFile::Storage::Heap : TextFile::Storage::None;
+    file.success = true;
+    return file;
 }
 
 struct Tracer {
@@ -80,7 +385,7 @@ struct Tracer {
 
     Variables within a block are destroyed in reverse order to their declarations.
 */
-int main() {
+int main(int argc, char** argv) {
     Tracer main { "MAIN!" };
     {
         printf("Block a!\n");
@@ -129,16 +434,63 @@ int main() {
         printf("Exception: %s\n", e.what());
     }
 
+    // Bulk narrowing: no exceptions, just the index of the first value that doesn't fit
+    {
+        std::vector<int> wide(1 << 16);  // fits in L2: this measures the check and the narrowing, not memory bandwidth
+        uint32_t seed { 0x5EED };
+        for (auto& value : wide) {
+            randomize(seed);
+            value = static_cast<int>(seed % 65536) - 32768;
+        }
+        std::vector<short> narrow(wide.size());
+        short_caster<int> caster;
+        using nanos = std::chrono::duration<double, std::nano>;
+
+        // 100 passes, best of five runs, so the comparison isn't about who ran first
+        auto best = [&](auto&& run) {
+            double fastest { 1e30 };
+            for (int round {}; round < 5; round++) {
+                const auto start = std::chrono::steady_clock::now();
+                for (int repeat {}; repeat < 100; repeat++) run();
+                const auto took = nanos(std::chrono::steady_clock::now() - start).count() / (100.0 * wide.size());
+                fastest = took < fastest ? took : fastest;
+            }
+            return fastest;
+        };
+        const auto per_value = best([&] {
+            for (size_t i {}; i < wide.size(); i++) {
+                try {
+                    narrow[i] = caster.cast(wide[i]);
+                } catch (const std::runtime_error&) {
+                    break;
+                }
+            }
+        });
+        size_t converted {};
+        const auto bulk = best([&] { converted = caster.cast_n(wide, narrow); });
+        printf("Narrowed %zu ints: cast() %.3f ns/value, cast_n %.3f ns/value\n", converted, per_value, bulk);
+
+        wide[27'182] = 142857;
+        printf("First value that doesn't fit in a short: index %zu\n", caster.cast_n(wide, narrow));
+    }
+
     // Structured Bindings example: TextFile POD is automatically unpacked into elements in left-to-right order from top-to-bottom
-    const auto [success, data, length] = read_text_file("README.txt");
+    // Reads this file's own source unless given a path; try a pipe too: ./ccc-8 <(echo hello)
+    const auto path = argc > 1 ? argv[1] : __FILE__;
+    const auto [success, data, length] = read_text_file(path, AccessHint::Sequential);
     if (success) {
-        printf("Read %ld bytes: %s\n", length, data);
+        const auto first_line = static_cast<const char*>(memchr(data, '\n', length));
+        printf("Read %zu bytes from %s: %.*s\n", length, path,
+               static_cast<int>(first_line ? first_line - data : static_cast<long>(length)), data);
     } else {
-        printf("Failed to read anything");
+        printf("Failed to read anything\n");
     }
 }
 
 // function declaration: the actual implementation of a function. Can be separate from definition
 void randomize(uint32_t& x) {
-    x = 0x3FFFFFFF & (0x41C64E6D * x + 12345) % 0x80000000; // a quick and dirty pseduo-random number generator
+    // a quick and dirty pseduo-random number generator. It used to be 0x3FFFFFFF & (...) % 0x80000000, but for an
+    // unsigned value % 2^31 just keeps the low 31 bits, and the mask keeps only 30 of those: one AND, same sequence.
+    // Hot paths that need real randomness should use the small-state engines in ccc-12 (prng::Xoshiro256ss etc.)
+    x = (0x41C64E6D * x + 12345) & 0x3FFFFFFF;
 }
\ No newline at end of file
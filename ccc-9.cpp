@@ -1,7 +1,51 @@
+// transform takes execution policies as tags. With -DCCC_WITH_TBB (and TBB installed) they are std::execution's, and
+// the benchmark also times std::transform(par_unseq), which libstdc++ runs on TBB:
+//     g++ -std=c++2a -O2 -DCCC_WITH_TBB ccc-9.cpp -pthread -ltbb
+// Otherwise <execution> isn't included at all, since libstdc++ makes it depend on TBB whenever TBB is installed, and
+// the local tags in namespace policy stand in, so a plain g++ file -pthread build still works.
+#if defined(CCC_WITH_TBB) && __has_include(<tbb/tbb.h>)
+#define CCC_STD_PARALLEL_TRANSFORM 1
+#include <execution>
+#else
+#define CCC_STD_PARALLEL_TRANSFORM 0
+#endif
+
 #include <cstdio>
 #include <cstdint>
 #include <cstdarg>
 #include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <chrono>
+
+namespace policy {
+#if CCC_STD_PARALLEL_TRANSFORM
+    using std::execution::sequenced_policy;
+    using std::execution::parallel_policy;
+    using std::execution::parallel_unsequenced_policy;
+    using std::execution::seq;
+    using std::execution::par;
+    using std::execution::par_unseq;
+    template<typename T>
+    inline constexpr bool is_execution_policy_v = std::is_execution_policy_v<T>;
+#else
+    struct sequenced_policy {};
+    struct parallel_policy {};
+    struct parallel_unsequenced_policy {};
+    inline constexpr sequenced_policy seq {};
+    inline constexpr parallel_policy par {};
+    inline constexpr parallel_unsequenced_policy par_unseq {};
+    template<typename T>
+    inline constexpr bool is_execution_policy_v = std::is_same_v<T, sequenced_policy> ||
+        std::is_same_v<T, parallel_policy> || std::is_same_v<T, parallel_unsequenced_policy>;
+#endif
+}
+
 
 /*
     function prefix modifiers:
@@ -124,13 +168,225 @@ struct CountIf {
     char x;
 };
 
-template<typename Fn>
-void transform(Fn fn, int* in, int* out, size_t length) {
+template<typename Fn, typename In, typename Out>
+void transform(Fn fn, const In* in, Out* out, size_t length) {
     for (size_t i {}; i < length; i++) {
         out[i] = fn(in[i]);
     }
 }
 
+/*
+    Fixed pool of worker threads for the parallel transform. run() hands out task indices through one atomic
+    counter; the calling thread pitches in too, so a single-core machine degrades to the serial loop.
+    The job is type-erased into a plain function pointer + context, not a std::function.
+*/
+struct ChunkPool {
+    static ChunkPool& instance() {
+        static ChunkPool pool { std::max(std::thread::hardware_concurrency(), 1u) - 1 };
+        return pool;
+    }
+
+    explicit ChunkPool(size_t n_workers) {
+        for (size_t i{}; i < n_workers; i++) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ChunkPool() {
+        {
+            std::lock_guard<std::mutex> guard { lock };
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    size_t size() const {
+        return workers.size() + 1;
+    }
+
+    // Runs task(i) for every i in [0, n_tasks) and returns once all of them are done
+    template<typename Task>
+    void run(size_t n_tasks, Task& task) {
+        std::lock_guard<std::mutex> one_job_at_a_time { run_lock };
+        {
+            std::lock_guard<std::mutex> guard { lock };
+            job = Job { [](void* ctx, size_t i) { (*static_cast<Task*>(ctx))(i); }, &task, n_tasks };
+            next.store(0);
+            remaining = n_tasks;
+            generation++;
+        }
+        wake.notify_all();
+        help(job);
+
+        // Wait for the tasks, and for every worker to be out of help() before the job can be replaced
+        std::unique_lock<std::mutex> guard { lock };
+        done.wait(guard, [this] { return remaining == 0 && active == 0; });
+    }
+
+    private:
+    struct Job {
+        void (*invoke)(void*, size_t);
+        void* ctx;
+        size_t n_tasks;
+    };
+
+    void work() {
+        size_t seen{};
+        std::unique_lock<std::mutex> guard { lock };
+        while (true) {
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            const auto current = job;
+            active++;
+            guard.unlock();
+            help(current);
+            guard.lock();
+            active--;
+            done.notify_all();
+        }
+    }
+
+    void help(const Job& current) {
+        size_t finished{};
+        for (size_t i; (i = next.fetch_add(1)) < current.n_tasks; finished++) {
+            current.invoke(current.ctx, i);
+        }
+        if (finished) {
+            std::lock_guard<std::mutex> guard { lock };
+            remaining -= finished;
+            if (remaining == 0) done.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex run_lock;
+    std::mutex lock;
+    std::condition_variable wake, done;
+    std::atomic<size_t> next {};
+    Job job {};
+    size_t remaining {};
+    size_t active {};
+    size_t generation {};
+    bool stopping {};
+};
+
+template<typename T>
+struct is_std_function : std::false_type {};
+template<typename Signature>
+struct is_std_function<std::function<Signature>> : std::true_type {};
+
+/*
+    transform with an execution policy (policy::seq, par or par_unseq):
+        - seq runs the plain loop above
+        - par and par_unseq split the range into chunks whose output starts on a 64-byte cache line, so two
+          threads never write the same line, and spread them over the ChunkPool. Each chunk is still a
+          simple counted loop over contiguous memory, which the compiler vectorizes when fn can be inlined.
+    A std::function can't be inlined: every element would become an indirect call and the loop could not
+    vectorize. Rather than quietly running that slow path, these overloads refuse std::function at compile time.
+*/
+// enable_if rather than requires: the chapter still builds in the compiler's default C++17 mode
+template<typename Policy, typename Fn, typename In, typename Out,
+         typename = std::enable_if_t<policy::is_execution_policy_v<std::decay_t<Policy>>>>
+void transform(Policy&&, Fn fn, const In* in, Out* out, size_t length) {
+    static_assert(!is_std_function<Fn>::value,
+        "std::function blocks inlining and vectorization: pass the lambda or function object itself");
+
+    if constexpr (std::is_same_v<std::decay_t<Policy>, policy::sequenced_policy>) {
+        transform(fn, in, out, length);
+    } else {
+        const size_t cache_line { 64 };
+        const size_t line_elements = cache_line % sizeof(Out) == 0 ? cache_line / sizeof(Out) : 1;
+        const size_t min_chunk { 16 * 1024 };
+        auto& pool = ChunkPool::instance();
+
+        const auto n_chunks = std::clamp<size_t>(length / min_chunk, 1, pool.size() * 4);
+        // round the share up before aligning it, so the chunks always cover the whole range
+        const auto share = (length + n_chunks - 1) / n_chunks;
+        const auto chunk = (share + line_elements - 1) / line_elements * line_elements;
+        // Elements before out's first cache-line boundary; every chunk after the first starts on a boundary
+        const auto misalignment = line_elements > 1
+            ? (reinterpret_cast<uintptr_t>(out) % cache_line) / sizeof(Out) : 0;
+        auto chunk_start = [&](size_t k) {
+            return k == 0 ? 0 : std::min(length, k * chunk - misalignment);
+        };
+
+        const auto n_tasks = n_chunks + (misalignment ? 1 : 0);
+        auto task = [&](size_t k) {
+            const auto begin = chunk_start(k);
+            const auto end = k + 1 == n_tasks ? length : chunk_start(k + 1);
+            transform(fn, in + begin, out + begin, end - begin);
+        };
+        pool.run(n_tasks, task);
+    }
+}
+
+// par and par_unseq must write exactly what the serial transform does: odd lengths, output aligned and not
+bool check_parallel_transform() {
+    const size_t max_length { 400'000 };
+    const auto in = new int[max_length];
+    // over-allocate so the output can start on a cache line plus 0..3 elements
+    const auto storage = new int[max_length + 32];
+    const auto aligned = reinterpret_cast<int*>((reinterpret_cast<uintptr_t>(storage) + 63) / 64 * 64);
+    const auto expected = new int[max_length];
+    for (size_t i{}; i < max_length; i++) in[i] = (int) i;
+    auto wild_ride = [](auto x) constexpr -> decltype(x) { return 10*x+5; };
+    transform(wild_ride, in, expected, max_length);
+
+    bool ok { true };
+    auto check = [&](auto policy, size_t length, size_t offset) {
+        const auto out = aligned + offset;
+        std::fill(out, out + length, -1);
+        transform(policy, wild_ride, in, out, length);
+        if (!std::equal(out, out + length, expected)) {
+            printf("parallel transform differs from serial: length %zu, offset %zu\n", length, offset);
+            ok = false;
+        }
+    };
+    for (size_t length { 1 }; length < max_length; length = length * 9 / 8 + 7) {
+        for (size_t offset{}; offset < 4; offset++) {
+            check(policy::par, length, offset);
+            check(policy::par_unseq, length, offset);
+        }
+    }
+    check(policy::par, 61249, 0);  // 3 chunks of 20416 plus one element
+
+    delete[] in;
+    delete[] storage;
+    delete[] expected;
+    return ok;
+}
+
+// Serial, our three policies and std::transform (plus std::transform(par_unseq) with TBB) over the same array
+void benchmark_transform(size_t length) {
+    const auto in = new int[length];
+    const auto out = new int[length];
+    for (size_t i{}; i < length; i++) in[i] = (int) i;
+    auto wild_ride = [](auto x) constexpr -> decltype(x) { return 10*x+5; };
+
+    auto time = [&](const char* name, auto&& run) {
+        run(); // warm up caches and the pool
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-32s %.2f ms (out[%zu] = %d)\n", name, elapsed.count(), length - 1, out[length - 1]);
+    };
+    time("transform", [&] { transform(wild_ride, in, out, length); });
+    time("transform(seq)", [&] { transform(policy::seq, wild_ride, in, out, length); });
+    time("transform(par)", [&] { transform(policy::par, wild_ride, in, out, length); });
+    time("transform(par_unseq)", [&] { transform(policy::par_unseq, wild_ride, in, out, length); });
+    time("std::transform", [&] { std::transform(in, in + length, out, wild_ride); });
+#if CCC_STD_PARALLEL_TRANSFORM
+    time("std::transform(par_unseq)", [&] {
+        std::transform(std::execution::par_unseq, in, in + length, out, wild_ride);
+    });
+#endif
+
+    delete[] in;
+    delete[] out;
+}
+
 void f() { printf("WOW A FUNCTION!\n"); }
 
 // std::function - stdlib wrapper around functions to convert them to function objects
@@ -171,6 +427,7 @@ int main() {
     const size_t length { 3 };
     int base[] { 1, 2, 3 }, a[length], b[length], c[length];
     auto wild_ride = [](auto x) constexpr -> decltype(x) { return 10*x+5; };
+    // fine for the serial transform; the execution-policy overloads reject std::function at compile time
     transform(std::function<int(int)> {[](int x) constexpr -> int { return 1; }}, base, a, length);
     transform([length](int x) constexpr { return x + (length + 1); }, base, b, length);
     transform(wild_ride, base, c, length);
@@ -179,4 +436,8 @@ int main() {
     }
 
     call(f); // passing a function as a parameter using the std::function wrapper
+
+    printf("par / par_unseq transform match serial: %s\n", check_parallel_transform() ? "yes" : "NO");
+
+    benchmark_transform(1 << 24);
 }
\ No newline at end of file